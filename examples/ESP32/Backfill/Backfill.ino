@@ -0,0 +1,117 @@
+/*
+  Backfill
+  
+  Description: Writes a CSV log kept on an SD card, for example while the network was down, to a ThingSpeak channel.  Each line
+               of the log is one row: the created-at timestamp in seconds since 1970-01-01 UTC, then up to 8 field values,
+               separated by commas, like "1709296496,21.5,40".  The rows are sent with one bulk update of up to 960 rows every
+               15 seconds.  The position in the log is saved in flash after every bulk update, so after a restart the log is
+               written on from the first row that was not written yet.
+  
+  Hardware: ESP32 based boards with an SD card
+  
+  !!! IMPORTANT - Modify the secrets.h file for this project with your network connection and ThingSpeak channel details. !!!
+  
+  Note:
+  - Requires installation of EPS32 core. See https://github.com/espressif/arduino-esp32/blob/master/docs/arduino-ide/boards_manager.md for details. 
+  - Select the target hardware from the Tools->Board menu
+  - This example is written for a network using WPA encryption. For WEP or WPA, change the WiFi.begin() call accordingly.
+  - Delete the saved position with preferences.clear() when a new log is started.
+  
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and 
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.  
+  
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+  
+  For licensing information, see the accompanying license file.
+  
+  Copyright 2020-2025, The MathWorks, Inc.
+*/
+
+#include <WiFi.h>
+#include <SD.h>
+#include <Preferences.h>
+#include "secrets.h"
+#include "ThingSpeak.h" // always include thingspeak header file after other header files and custom macros
+
+#define LOG_FILE "/log.csv"
+#define ROWS_PER_UPDATE 960  // most rows ThingSpeak takes in one bulk update
+
+char ssid[] = SECRET_SSID;   // your network SSID (name) 
+char pass[] = SECRET_PASS;   // your network password
+WiFiClient  client;
+
+unsigned long myChannelNumber = SECRET_CH_ID;
+const char * myWriteAPIKey = SECRET_WRITE_APIKEY;
+
+queuedUpdate rows[ROWS_PER_UPDATE];
+backfillJob job = { myChannelNumber, myWriteAPIKey, rows, ROWS_PER_UPDATE };
+File logFile;
+Preferences preferences;
+
+void setup() {
+  Serial.begin(115200);  //Initialize serial
+  while (!Serial) {
+    ; // wait for serial port to connect. Needed for Leonardo native USB port only
+  }
+  
+  WiFi.mode(WIFI_STA);   
+  ThingSpeak.begin(client);  // Initialize ThingSpeak
+  ThingSpeak.setKeepAlive(true);
+
+  if(!SD.begin() || !(logFile = SD.open(LOG_FILE))){
+    Serial.println("Cannot open " LOG_FILE " on the SD card.");
+    while(true) delay(1000);
+  }
+
+  // Go on where the last run stopped
+  preferences.begin("backfill");
+  job.offset = preferences.getUInt("offset", 0);
+  logFile.seek(job.offset);
+  ThingSpeak.beginBackfill(job);
+  Serial.print("Writing " LOG_FILE " from byte ");
+  Serial.print(job.offset);
+  Serial.print(" of ");
+  Serial.println(logFile.size());
+}
+
+void loop() {
+
+  // Connect or reconnect to WiFi
+  if(WiFi.status() != WL_CONNECTED){
+    Serial.print("Attempting to connect to SSID: ");
+    Serial.println(SECRET_SSID);
+    while(WiFi.status() != WL_CONNECTED){
+      WiFi.begin(ssid, pass);  // Connect to WPA/WPA2 network. Change this line if using open or WEP network
+      Serial.print(".");
+      delay(5000);     
+    } 
+    Serial.println("\nConnected.");
+  }
+
+  if(ThingSpeak.isBackfillDone(job)){
+    return;
+  }
+
+  // Write the next rows when the rate limit allows it
+  int status = ThingSpeak.serviceBackfill(job, logFile);
+  if(status == TS_OK_SUCCESS){
+    preferences.putUInt("offset", job.offset);
+    Serial.print("Rows written: ");
+    Serial.print(job.rowsWritten);
+    Serial.print(", rows/s: ");
+    Serial.print(ThingSpeak.getBackfillRate(job));
+    Serial.print(", byte ");
+    Serial.print(job.offset);
+    Serial.print(" of ");
+    Serial.println(logFile.size());
+  }
+  else if(status != TS_ERR_QUEUE_EMPTY){
+    Serial.println("Problem writing rows, they are sent again. HTTP error code " + String(status));
+  }
+
+  if(ThingSpeak.isBackfillDone(job)){
+    Serial.print("Done, skipped lines: ");
+    Serial.println(job.rowsSkipped);
+  }
+}
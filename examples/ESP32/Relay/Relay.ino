@@ -0,0 +1,103 @@
+/*
+  Relay
+  
+  Description: Relays the updates of devices on the local network to ThingSpeak.  The devices write to the relay instead of to ThingSpeak,
+               with ThingSpeak.begin(client, "<relay IP address>", 80) and the usual writeField() or writeFields().  Each update is
+               acknowledged right away and kept in the update queue of its channel.  The queued updates of a channel are sent to
+               ThingSpeak with one bulk update once every 15 seconds, so any number of devices can share a channel without hitting
+               the rate limit, and the relay keeps a single connection to ThingSpeak open for all channels.
+  
+  Hardware: ESP32 based boards
+  
+  !!! IMPORTANT - Modify the secrets.h file for this project with your network connection and ThingSpeak channel details. !!!
+  
+  Note:
+  - Requires installation of EPS32 core. See https://github.com/espressif/arduino-esp32/blob/master/docs/arduino-ide/boards_manager.md for details. 
+  - Select the target hardware from the Tools->Board menu
+  - This example is written for a network using WPA encryption. For WEP or WPA, change the WiFi.begin() call accordingly.
+  - Queued updates are kept in RAM and are lost when the relay restarts.  Only numeric field values are relayed.
+  
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and 
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.  
+  
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+  
+  For licensing information, see the accompanying license file.
+  
+  Copyright 2020-2025, The MathWorks, Inc.
+*/
+
+#include <WiFi.h>
+#include "secrets.h"
+#include "ThingSpeak.h" // always include thingspeak header file after other header files and custom macros
+#include "ThingSpeakRelay.h"
+
+#define NUM_CHANNELS 2
+#define QUEUE_SIZE 100  // updates kept per channel
+
+char ssid[] = SECRET_SSID;   // your network SSID (name) 
+char pass[] = SECRET_PASS;   // your network password
+WiFiClient  client;          // connection to ThingSpeak
+WiFiServer  server(80);      // connections from the devices
+
+queuedUpdate updates[NUM_CHANNELS][QUEUE_SIZE];
+gatewayChannel channels[NUM_CHANNELS] = {
+  { SECRET_CH_ID_1, SECRET_WRITE_APIKEY_1, updates[0], QUEUE_SIZE },
+  { SECRET_CH_ID_2, SECRET_WRITE_APIKEY_2, updates[1], QUEUE_SIZE }
+};
+
+void setup() {
+  Serial.begin(115200);  //Initialize serial
+  while (!Serial) {
+    ; // wait for serial port to connect. Needed for Leonardo native USB port only
+  }
+  
+  WiFi.mode(WIFI_STA);   
+  ThingSpeak.begin(client);  // Initialize ThingSpeak
+  ThingSpeak.setKeepAlive(true);
+  ThingSpeak.setGatewayChannels(channels, NUM_CHANNELS);
+}
+
+void loop() {
+
+  // Connect or reconnect to WiFi
+  if(WiFi.status() != WL_CONNECTED){
+    Serial.print("Attempting to connect to SSID: ");
+    Serial.println(SECRET_SSID);
+    while(WiFi.status() != WL_CONNECTED){
+      WiFi.begin(ssid, pass);  // Connect to WPA/WPA2 network. Change this line if using open or WEP network
+      Serial.print(".");
+      delay(5000);     
+    } 
+    Serial.print("\nConnected, relay address: ");
+    Serial.println(WiFi.localIP());
+    server.begin();
+  }
+
+  // Take the updates of all devices that are waiting
+  WiFiClient device = server.available();
+  while(device){
+    int status = relayHandleRequest(device, channels, NUM_CHANNELS);
+    device.stop();
+    if(status == TS_ERR_BADURL || status == TS_ERR_BADAPIKEY){
+      Serial.println("Rejected a request that is not an update for one of the channels.");
+    }
+    else if(status != TS_OK_SUCCESS){
+      Serial.println("Update was not queued, error code " + String(status));
+    }
+    device = server.available();
+  }
+
+  // Forward the queued updates of one channel whose turn it is
+  int status = ThingSpeak.serviceGateway();
+  if(status == TS_OK_SUCCESS){
+    Serial.print("Forwarded updates to channel ");
+    Serial.print(ThingSpeak.getGatewayChannel());
+    Serial.print(", still queued: ");
+    Serial.println(ThingSpeak.getGatewayQueuedCount());
+  }
+  else if(status != TS_ERR_QUEUE_EMPTY){
+    Serial.println("Problem forwarding updates. HTTP error code " + String(status));
+  }
+}
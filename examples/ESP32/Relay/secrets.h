@@ -0,0 +1,10 @@
+// Use this file to store all of the private credentials 
+// and connection details
+
+#define SECRET_SSID "MySSID"		// replace MySSID with your WiFi network name
+#define SECRET_PASS "MyPassword"	// replace MyPassword with your WiFi password
+
+#define SECRET_CH_ID_1 000000			// replace 0000000 with the number of the first channel
+#define SECRET_WRITE_APIKEY_1 "XYZ"   // replace XYZ with the write API Key of the first channel
+#define SECRET_CH_ID_2 000000			// replace 0000000 with the number of the second channel
+#define SECRET_WRITE_APIKEY_2 "XYZ"   // replace XYZ with the write API Key of the second channel
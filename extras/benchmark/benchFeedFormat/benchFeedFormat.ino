@@ -0,0 +1,116 @@
+/*
+  benchFeedFormat
+
+  Compares the JSON and CSV feed formats of readFeedColumns() on the same set of updates.
+  Both responses are replayed from memory, so the numbers show the transfer size and the
+  parse time on this board, without network latency.
+
+  Prints, for each format, the response size in bytes and the average time per read in microseconds.
+
+  Needs a board with enough RAM to hold both responses (ESP8266, ESP32, SAMD, RP2040 or similar).
+
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and 
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.  
+  
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+  
+  For licensing information, see the accompanying license file.
+  
+  Copyright 2020-2025, The MathWorks, Inc.
+*/
+
+#include "ThingSpeakReplayClient.h"
+#include "ThingSpeak.h" // always include thingspeak header file after other header files and custom macros
+
+#define NUM_UPDATES 100
+#define NUM_REPEATS 10
+
+ReplayClient client;
+String jsonResponse;
+String csvResponse;
+
+float field1Values[NUM_UPDATES];
+float field2Values[NUM_UPDATES];
+float field3Values[NUM_UPDATES];
+uint32_t createdAtValues[NUM_UPDATES];
+
+String makeTimestamp(int i, char separator, const char * zone)
+{
+  char timestamp[32];
+  sprintf(timestamp, "2024-03-01%c%02d:%02d:%02d%s", separator, (i / 60) % 24, i % 60, (i * 7) % 60, zone);
+  return String(timestamp);
+}
+
+String makeResponse(String body)
+{
+  String response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: ";
+  response.concat(body.length());
+  response.concat("\r\n\r\n");
+  response.concat(body);
+  return response;
+}
+
+void buildResponses()
+{
+  String json = "{\"channel\":{\"id\":1,\"name\":\"Benchmark\",\"field1\":\"Temperature\",\"field2\":\"Humidity\",\"field3\":\"Pressure\",\"last_entry_id\":100},\"feeds\":[";
+  String csv = "created_at,entry_id,field1,field2,field3\n";
+  for(int i = 0; i < NUM_UPDATES; i++)
+  {
+    String field1 = String(20.0 + (i % 50) / 10.0, 2);
+    String field2 = String(40 + i % 30);
+    String field3 = String(1013.25 - (i % 20) / 4.0, 2);
+
+    if(i > 0) json.concat(",");
+    json.concat("{\"created_at\":\"" + makeTimestamp(i, 'T', "Z") + "\",\"entry_id\":" + String(i + 1));
+    json.concat(",\"field1\":\"" + field1 + "\",\"field2\":\"" + field2 + "\",\"field3\":\"" + field3 + "\"}");
+
+    csv.concat(makeTimestamp(i, ' ', " UTC") + "," + String(i + 1) + "," + field1 + "," + field2 + "," + field3 + "\n");
+  }
+  json.concat("]}");
+
+  jsonResponse = makeResponse(json);
+  csvResponse = makeResponse(csv);
+}
+
+void runBenchmark(const char * name, int format, String & response)
+{
+  feedColumns columns = {};
+  columns.createdAt = createdAtValues;
+  columns.field[0] = field1Values;
+  columns.field[1] = field2Values;
+  columns.field[2] = field3Values;
+  columns.capacity = NUM_UPDATES;
+
+  client.setResponse(response.c_str(), response.length());
+  ThingSpeak.setFeedFormat(format);
+
+  unsigned long start = micros();
+  for(int i = 0; i < NUM_REPEATS; i++)
+  {
+    ThingSpeak.readFeedColumns(1, NUM_UPDATES, columns);
+  }
+  unsigned long elapsed = micros() - start;
+
+  Serial.print(name);
+  Serial.print(": status "); Serial.print(ThingSpeak.getLastReadStatus());
+  Serial.print(", updates "); Serial.print(columns.count);
+  Serial.print(", bytes "); Serial.print(response.length());
+  Serial.print(", us/read "); Serial.println(elapsed / NUM_REPEATS);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while(!Serial); // for the Arduino Leonardo/Micro only
+
+  buildResponses();
+  ThingSpeak.begin(client);
+
+  runBenchmark("JSON", TS_FEED_FORMAT_JSON, jsonResponse);
+  runBenchmark("CSV ", TS_FEED_FORMAT_CSV, csvResponse);
+}
+
+void loop()
+{
+}
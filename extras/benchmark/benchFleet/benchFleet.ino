@@ -0,0 +1,209 @@
+/*
+  benchFleet
+
+  Simulates a fleet of devices that all wake up at once, like after a power outage, and write to
+  ThingSpeak.  Every device is its own ThingSpeakClass with its own ReplayClient.  The server is a
+  token bucket that accepts SERVER_RATE writes per second with bursts of SERVER_BURST, and answers
+  other writes like ThingSpeak answers a write over the rate limit (entry ID 0, -401 on the device).
+  Devices retry failed writes, either after a fixed delay or with exponential backoff and jitter.
+
+  The simulation runs in virtual time: a device's write happens at its scheduled time whatever the
+  writes cost on this board, which is measured separately.
+
+  Prints, for each retry policy, the devices that got their update through, the writes accepted per
+  second, the time from waking up to an accepted write (median, 99th percentile and longest), the
+  retries in total and the most writes the server saw in one second (the retry storm), the time one
+  write takes on this board, and the memory each simulated device takes.
+
+  Set FLEET_SIZE to what fits the RAM of the board, about 200 on an ESP32.
+
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.
+
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+
+  For licensing information, see the accompanying license file.
+
+  Copyright 2020-2025, The MathWorks, Inc.
+*/
+
+#include "ThingSpeakReplayClient.h"
+#include "ThingSpeak.h" // always include thingspeak header file after other header files and custom macros
+
+#ifndef FLEET_SIZE
+  #define FLEET_SIZE 200
+#endif
+#define WAKE_SPREAD_MS 2000      // devices wake up within this time
+#define SERVER_RATE 50           // writes per second the server accepts
+#define SERVER_BURST 20          // writes the server accepts at once after being idle
+#define MAX_ATTEMPTS 30          // a device gives up after this many writes
+#define RETRY_DELAY_MS 1000      // fixed delay, and first delay of the backoff
+#define RETRY_DELAY_MAX_MS 60000 // longest delay of the backoff
+#define STORM_SECONDS 900        // length of the per-second write count
+
+#define POLICY_FIXED 0
+#define POLICY_BACKOFF 1
+
+const char acceptedResponse[] = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 4\r\n\r\n4242";
+const char rejectedResponse[] = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 1\r\n\r\n0";
+const char * writeAPIKey = "XXXXXXXXXXXXXXXX";
+
+struct simDevice
+{
+  ThingSpeakClass * ts;
+  ReplayClient * client;
+  uint32_t wakeAt;
+  uint32_t nextAttempt;
+  uint32_t doneAt;
+  uint16_t attempts;
+  bool done;
+};
+
+simDevice fleet[FLEET_SIZE];
+uint32_t latencies[FLEET_SIZE];
+uint16_t writesPerSecond[STORM_SECONDS];
+
+// token bucket of the server, in thousandths of a write
+long serverTokens;
+uint32_t serverLastRefill;
+
+long freeHeap()
+{
+  #if defined(ESP8266) || defined(ESP32)
+    return ESP.getFreeHeap();
+  #elif defined(ARDUINO_ARCH_RP2040)
+    return rp2040.getFreeHeap();
+  #else
+    return -1;
+  #endif
+}
+
+bool serverAccepts(uint32_t now)
+{
+  serverTokens += (long)(now - serverLastRefill) * SERVER_RATE;
+  if(serverTokens > SERVER_BURST * 1000L) serverTokens = SERVER_BURST * 1000L;
+  serverLastRefill = now;
+  if(serverTokens < 1000) return false;
+  serverTokens -= 1000;
+  return true;
+}
+
+uint32_t retryDelay(int policy, uint16_t attempts)
+{
+  if(policy == POLICY_FIXED) return RETRY_DELAY_MS;
+  uint32_t delayMS = RETRY_DELAY_MS;
+  for(uint16_t i = 1; i < attempts && delayMS < RETRY_DELAY_MAX_MS; i++) delayMS *= 2;
+  if(delayMS > RETRY_DELAY_MAX_MS) delayMS = RETRY_DELAY_MAX_MS;
+  return delayMS / 2 + random(delayMS); // jitter of +-50%
+}
+
+int compareLatency(const void * a, const void * b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+void runSimulation(const char * name, int policy)
+{
+  randomSeed(1);
+  for(int d = 0; d < FLEET_SIZE; d++)
+  {
+    fleet[d].wakeAt = random(WAKE_SPREAD_MS);
+    fleet[d].nextAttempt = fleet[d].wakeAt;
+    fleet[d].attempts = 0;
+    fleet[d].done = false;
+  }
+  memset(writesPerSecond, 0, sizeof(writesPerSecond));
+  serverTokens = SERVER_BURST * 1000L;
+  serverLastRefill = 0;
+
+  unsigned long writes = 0;
+  unsigned long writeMicros = 0;
+  unsigned int numDone = 0;
+  uint32_t lastDone = 0;
+  while(true)
+  {
+    // next device due, in virtual time
+    int next = -1;
+    for(int d = 0; d < FLEET_SIZE; d++)
+    {
+      if(fleet[d].done || fleet[d].attempts >= MAX_ATTEMPTS) continue;
+      if(next < 0 || fleet[d].nextAttempt < fleet[next].nextAttempt) next = d;
+    }
+    if(next < 0) break;
+
+    simDevice & device = fleet[next];
+    uint32_t now = device.nextAttempt;
+    if(now / 1000 < STORM_SECONDS) writesPerSecond[now / 1000]++;
+    if(serverAccepts(now)) device.client->setResponse(acceptedResponse, sizeof(acceptedResponse) - 1);
+    else device.client->setResponse(rejectedResponse, sizeof(rejectedResponse) - 1);
+
+    unsigned long start = micros();
+    int status = device.ts->writeField(next + 1, 1, (int)device.attempts, writeAPIKey);
+    writeMicros += micros() - start;
+    writes++;
+    device.attempts++;
+
+    if(status == TS_OK_SUCCESS)
+    {
+      device.done = true;
+      device.doneAt = now;
+      latencies[numDone++] = now - device.wakeAt;
+      lastDone = now;
+    }
+    else
+    {
+      device.nextAttempt = now + retryDelay(policy, device.attempts);
+    }
+  }
+
+  uint16_t storm = 0;
+  for(int s = 0; s < STORM_SECONDS; s++)
+  {
+    if(writesPerSecond[s] > storm) storm = writesPerSecond[s];
+  }
+  qsort(latencies, numDone, sizeof(latencies[0]), compareLatency);
+
+  Serial.print(name);
+  Serial.print(": done "); Serial.print(numDone); Serial.print("/"); Serial.print(FLEET_SIZE);
+  Serial.print(", accepted/s "); Serial.print(1000.0 * numDone / (lastDone > 0 ? lastDone : 1), 1);
+  if(numDone > 0)
+  {
+    Serial.print(", latency ms p50 "); Serial.print(latencies[numDone / 2]);
+    Serial.print(" p99 "); Serial.print(latencies[(numDone * 99) / 100]);
+    Serial.print(" max "); Serial.print(latencies[numDone - 1]);
+  }
+  Serial.print(", retries "); Serial.print(writes - numDone);
+  Serial.print(", peak writes/s "); Serial.print(storm);
+  Serial.print(", us/write "); Serial.println(writeMicros / (writes > 0 ? writes : 1));
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while(!Serial); // for the Arduino Leonardo/Micro only
+
+  long heapBefore = freeHeap();
+  for(int d = 0; d < FLEET_SIZE; d++)
+  {
+    fleet[d].client = new ReplayClient();
+    fleet[d].ts = new ThingSpeakClass();
+    fleet[d].ts->begin(*fleet[d].client);
+  }
+  long heapAfter = freeHeap();
+
+  Serial.print("devices "); Serial.print(FLEET_SIZE);
+  Serial.print(", bytes/device "); Serial.print(sizeof(ThingSpeakClass) + sizeof(ReplayClient));
+  Serial.print(", heap/device ");
+  if(heapBefore < 0) Serial.println("n/a");
+  else Serial.println((heapBefore - heapAfter) / FLEET_SIZE);
+
+  runSimulation("fixed retry      ", POLICY_FIXED);
+  runSimulation("backoff + jitter ", POLICY_BACKOFF);
+}
+
+void loop()
+{
+}
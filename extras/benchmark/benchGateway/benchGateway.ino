@@ -0,0 +1,136 @@
+/*
+  benchGateway
+
+  Measures gateway mode (setGatewayChannels(), queueChannelFields() and serviceGateway()) on a number
+  of channels, with and without keep-alive.  The requests go to a ReplayClient that answers with a
+  recorded bulk update response.  Connecting takes CONNECT_DELAY_US, about what a TLS handshake takes,
+  and the response arrives ARRIVAL_DELAY_US after the request, about a round trip to ThingSpeak.  The
+  rate limit between writes to a channel is set to zero so that only the cost of the writes is measured.
+
+  serviceGateway() writes through a blocking Client: each call sends one request and waits for its
+  response before the next channel is written, so the requests are not overlapped.  A round then takes
+  about one round trip per channel, plus a connect per channel without keep-alive, and the numbers show
+  what reusing one connection for all channels saves, not how many requests could be in flight.
+
+  Prints, for each number of channels and connection mode, the updates written per second, the
+  requests and connections per round, and the change in free heap over all rounds ("n/a" on boards
+  without a free heap query).
+
+  Needs a board with enough RAM for the queues of 32 channels (ESP8266, ESP32, SAMD, RP2040 or similar).
+
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.
+
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+
+  For licensing information, see the accompanying license file.
+
+  Copyright 2020-2025, The MathWorks, Inc.
+*/
+
+#include "ThingSpeakReplayClient.h"
+#include "ThingSpeak.h" // always include thingspeak header file after other header files and custom macros
+
+#define MAX_CHANNELS 32
+#define UPDATES_PER_CHANNEL 4
+#define NUM_ROUNDS 5
+#define CONNECT_DELAY_US 50000
+#define ARRIVAL_DELAY_US 100000
+
+const char bulkResponse[] = "HTTP/1.1 202 Accepted\r\nContent-Type: application/json\r\nConnection: keep-alive\r\nContent-Length: 16\r\n\r\n{\"success\":true}";
+
+// number of channels served by the gateway in each case
+const unsigned int channelCounts[] = { 1, 8, 32 };
+
+ReplayClient client;
+gatewayChannel channels[MAX_CHANNELS];
+queuedUpdate updates[MAX_CHANNELS][UPDATES_PER_CHANNEL];
+
+long freeHeap()
+{
+  #if defined(ESP8266) || defined(ESP32)
+    return ESP.getFreeHeap();
+  #elif defined(ARDUINO_ARCH_RP2040)
+    return rp2040.getFreeHeap();
+  #else
+    return -1;
+  #endif
+}
+
+// queues a full queue of updates on every channel, then writes them all
+unsigned long runRound(unsigned int numChannels)
+{
+  for(unsigned int c = 0; c < numChannels; c++)
+  {
+    for(int u = 0; u < UPDATES_PER_CHANNEL; u++)
+    {
+      ThingSpeak.setField(1, (int)u);
+      ThingSpeak.setField(2, (float)(c + 0.5));
+      ThingSpeak.queueChannelFields(channels[c].channelNumber);
+    }
+  }
+  unsigned long requests = 0;
+  while(ThingSpeak.serviceGateway() != TS_ERR_QUEUE_EMPTY)
+  {
+    requests++;
+  }
+  return requests;
+}
+
+void runBenchmark(unsigned int numChannels, bool keepAlive)
+{
+  for(unsigned int c = 0; c < numChannels; c++)
+  {
+    channels[c].channelNumber = 1000 + c;
+    channels[c].writeAPIKey = "XXXXXXXXXXXXXXXX";
+    channels[c].updates = updates[c];
+    channels[c].capacity = UPDATES_PER_CHANNEL;
+  }
+  ThingSpeak.setGatewayChannels(channels, numChannels, 0);
+  ThingSpeak.setKeepAlive(keepAlive);
+  runRound(numChannels); // warm up
+  client.resetCounters();
+
+  unsigned long requests = 0;
+  long heapBefore = freeHeap();
+  unsigned long start = micros();
+  for(int i = 0; i < NUM_ROUNDS; i++)
+  {
+    requests += runRound(numChannels);
+  }
+  unsigned long elapsed = micros() - start;
+  long heapAfter = freeHeap();
+  ThingSpeak.setKeepAlive(false);
+
+  Serial.print("channels "); if(numChannels < 10) Serial.print(" "); Serial.print(numChannels);
+  Serial.print(keepAlive ? " keep-alive" : "           ");
+  Serial.print(": updates/s "); Serial.print(1000000.0 * numChannels * UPDATES_PER_CHANNEL * NUM_ROUNDS / (elapsed > 0 ? elapsed : 1), 1);
+  Serial.print(", requests/round "); Serial.print(requests / NUM_ROUNDS);
+  Serial.print(", connects/round "); Serial.print(client.connects / NUM_ROUNDS);
+  Serial.print(", heap change ");
+  if(heapBefore < 0) Serial.println("n/a");
+  else Serial.println(heapAfter - heapBefore);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while(!Serial); // for the Arduino Leonardo/Micro only
+
+  client.setResponse(bulkResponse, sizeof(bulkResponse) - 1);
+  client.setConnectDelay(CONNECT_DELAY_US);
+  client.setArrivalDelay(ARRIVAL_DELAY_US);
+  ThingSpeak.begin(client);
+
+  for(size_t i = 0; i < sizeof(channelCounts) / sizeof(channelCounts[0]); i++)
+  {
+    runBenchmark(channelCounts[i], false);
+    runBenchmark(channelCounts[i], true);
+  }
+  ThingSpeak.setGatewayChannels(NULL, 0);
+}
+
+void loop()
+{
+}
@@ -0,0 +1,163 @@
+/*
+  benchRead
+
+  Measures the read path of the library on recorded ThingSpeak responses: the response parsing behind
+  readFloatField() (/fields/N/last), readCreatedAt() (JSON key lookup in /feeds/last.txt),
+  readMultipleFields() (/feeds/last.txt?status=true&location=true) and readFeedColumns() (a large
+  /feeds.json).  The responses are replayed by a ReplayClient in chunks of a given size, with a given
+  delay before each chunk, to show how the library copes with data that arrives piece by piece.
+
+  Prints, for each response and arrival pattern, the average latency per read in microseconds, the
+  parse throughput in MB/s, the read() calls per read, and the change in free heap over all repeats
+  ("n/a" on boards without a free heap query).
+
+  Needs a board with enough RAM to hold the feed response (ESP8266, ESP32, SAMD, RP2040 or similar).
+
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.
+
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+
+  For licensing information, see the accompanying license file.
+
+  Copyright 2020-2025, The MathWorks, Inc.
+*/
+
+#include "ThingSpeakReplayClient.h"
+#include "ThingSpeak.h" // always include thingspeak header file after other header files and custom macros
+
+#define NUM_REPEATS 10
+#define NUM_UPDATES 100
+
+// chunk size in bytes and delay before each chunk in microseconds
+const size_t chunkSizes[] = { 1460, 64, 8 };
+const unsigned long arrivalDelays[] = { 0, 200 };
+
+ReplayClient client;
+String fieldResponse;
+String fieldLongResponse;
+String lastResponse;
+String feedResponse;
+
+float fieldValues[8][NUM_UPDATES];
+uint32_t createdAtValues[NUM_UPDATES];
+
+long freeHeap()
+{
+  #if defined(ESP8266) || defined(ESP32)
+    return ESP.getFreeHeap();
+  #elif defined(ARDUINO_ARCH_RP2040)
+    return rp2040.getFreeHeap();
+  #else
+    return -1;
+  #endif
+}
+
+String makeResponse(String body)
+{
+  String response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain; charset=utf-8\r\nConnection: keep-alive\r\nStatus: 200 OK\r\nCache-Control: max-age=7, private\r\nAccess-Control-Allow-Origin: *\r\nContent-Length: ";
+  response.concat(body.length());
+  response.concat("\r\n\r\n");
+  response.concat(body);
+  return response;
+}
+
+void buildResponses()
+{
+  fieldResponse = makeResponse("23.45");
+  fieldLongResponse = makeResponse("-1234567.875");
+
+  lastResponse = makeResponse("{\"created_at\":\"2024-03-01T12:34:56Z\",\"entry_id\":4242,\"field1\":\"23.45\",\"field2\":\"41\",\"field3\":\"1013.25\",\"field4\":\"0.5\",\"field5\":\"on\",\"field6\":\"-7.125\",\"field7\":\"12\",\"field8\":\"3.3\",\"latitude\":\"42.2995\",\"longitude\":\"-71.3507\",\"elevation\":\"59\",\"status\":\"battery ok\"}");
+
+  String json = "{\"channel\":{\"id\":1,\"name\":\"Benchmark\",\"latitude\":\"0.0\",\"longitude\":\"0.0\",\"field1\":\"Temperature\",\"field2\":\"Humidity\",\"field3\":\"Pressure\",\"field4\":\"Wind\",\"field5\":\"Rain\",\"field6\":\"Dew point\",\"field7\":\"UV\",\"field8\":\"Battery\",\"created_at\":\"2020-01-01T00:00:00Z\",\"updated_at\":\"2024-03-01T00:00:00Z\",\"last_entry_id\":100},\"feeds\":[";
+  for(int i = 0; i < NUM_UPDATES; i++)
+  {
+    char timestamp[24];
+    sprintf(timestamp, "2024-03-01T%02d:%02d:%02dZ", (i / 60) % 24, i % 60, (i * 7) % 60);
+    if(i > 0) json.concat(",");
+    json.concat("{\"created_at\":\"");
+    json.concat(timestamp);
+    json.concat("\",\"entry_id\":");
+    json.concat(i + 1);
+    for(int f = 0; f < 8; f++)
+    {
+      json.concat(",\"field");
+      json.concat(f + 1);
+      json.concat("\":\"");
+      json.concat(String(10.0 * f + (i % 50) / 10.0, 2));
+      json.concat("\"");
+    }
+    json.concat("}");
+  }
+  json.concat("]}");
+  feedResponse = makeResponse(json);
+}
+
+void readField()      { ThingSpeak.readFloatField(1, 1); }
+void readCreatedAt()  { ThingSpeak.readCreatedAt(1); }
+void readMultiple()   { ThingSpeak.readMultipleFields(1); }
+
+void readFeed()
+{
+  feedColumns columns = {};
+  columns.createdAt = createdAtValues;
+  for(int f = 0; f < 8; f++) columns.field[f] = fieldValues[f];
+  columns.capacity = NUM_UPDATES;
+  ThingSpeak.readFeedColumns(1, NUM_UPDATES, columns);
+}
+
+void runBenchmark(const char * name, void (*operation)(), String & response)
+{
+  for(size_t iChunk = 0; iChunk < sizeof(chunkSizes) / sizeof(chunkSizes[0]); iChunk++)
+  {
+    for(size_t iDelay = 0; iDelay < sizeof(arrivalDelays) / sizeof(arrivalDelays[0]); iDelay++)
+    {
+      client.setResponse(response.c_str(), response.length());
+      client.setChunkSize(chunkSizes[iChunk]);
+      client.setArrivalDelay(arrivalDelays[iDelay]);
+      operation(); // warm up
+      client.resetCounters();
+
+      long heapBefore = freeHeap();
+      unsigned long start = micros();
+      for(int i = 0; i < NUM_REPEATS; i++)
+      {
+        operation();
+      }
+      unsigned long elapsed = micros() - start;
+      long heapAfter = freeHeap();
+
+      Serial.print(name);
+      Serial.print(" chunk "); Serial.print(chunkSizes[iChunk]);
+      Serial.print(" delay us "); Serial.print(arrivalDelays[iDelay]);
+      Serial.print(": status "); Serial.print(ThingSpeak.getLastReadStatus());
+      Serial.print(", bytes "); Serial.print(response.length());
+      Serial.print(", us/read "); Serial.print(elapsed / NUM_REPEATS);
+      Serial.print(", MB/s "); Serial.print((float)client.bytesRead / (elapsed > 0 ? elapsed : 1), 2); // bytes per microsecond
+      Serial.print(", read calls/read "); Serial.print(client.readCalls / NUM_REPEATS);
+      Serial.print(", heap change ");
+      if(heapBefore < 0) Serial.println("n/a");
+      else Serial.println(heapAfter - heapBefore);
+    }
+  }
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while(!Serial); // for the Arduino Leonardo/Micro only
+
+  buildResponses();
+  ThingSpeak.begin(client);
+
+  runBenchmark("fields/1/last      ", readField, fieldResponse);
+  runBenchmark("fields/1/last long ", readField, fieldLongResponse);
+  runBenchmark("feeds/last created ", readCreatedAt, lastResponse);
+  runBenchmark("feeds/last multiple", readMultiple, lastResponse);
+  runBenchmark("feeds.json         ", readFeed, feedResponse);
+}
+
+void loop()
+{
+}
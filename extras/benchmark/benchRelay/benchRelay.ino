@@ -0,0 +1,148 @@
+/*
+  benchRelay
+
+  Measures the Relay example (examples/ESP32/Relay) with 1 to 1000 simulated devices.  Each device
+  sends one update request, as writeFields() sends it, to relayHandleRequest(); then the queued
+  updates are forwarded with serviceGateway() until all queues are empty.  Devices and ThingSpeak are
+  ReplayClients, connecting to ThingSpeak takes CONNECT_DELAY_US, its response arrives ARRIVAL_DELAY_US
+  after the request, about a round trip, and the rate limit between writes to a channel is set to zero
+  so that only the cost of the relay is measured.  Each bulk update waits for its response before the
+  next one is sent.
+
+  Prints, for each number of devices, the average and longest time until a device was acknowledged in
+  microseconds, the updates relayed per second including the forwarding, the bulk updates and the
+  connections to ThingSpeak it took, and the change in free heap ("n/a" on boards without a free heap
+  query).
+
+  Needs a board with enough RAM for the queues of 8 channels of 128 updates (ESP32, RP2040 or similar).
+  The requests are handled by ThingSpeakRelay.h of the library, the code the Relay example runs.
+
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.
+
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+
+  For licensing information, see the accompanying license file.
+
+  Copyright 2020-2025, The MathWorks, Inc.
+*/
+
+#include "ThingSpeakReplayClient.h"
+#include "ThingSpeak.h" // always include thingspeak header file after other header files and custom macros
+#include "ThingSpeakRelay.h"
+
+#define NUM_CHANNELS 8
+#define QUEUE_SIZE 128
+#define CONNECT_DELAY_US 50000
+#define ARRIVAL_DELAY_US 100000
+
+const char bulkResponse[] = "HTTP/1.1 202 Accepted\r\nContent-Type: application/json\r\nConnection: keep-alive\r\nContent-Length: 16\r\n\r\n{\"success\":true}";
+
+// number of devices in each case, devices are spread evenly over the channels
+const unsigned int deviceCounts[] = { 1, 10, 100, 1000 };
+
+ReplayClient upstream;
+ReplayClient device;
+String requests[NUM_CHANNELS];
+char writeAPIKeys[NUM_CHANNELS][17];
+gatewayChannel channels[NUM_CHANNELS];
+queuedUpdate updates[NUM_CHANNELS][QUEUE_SIZE];
+
+long freeHeap()
+{
+  #if defined(ESP8266) || defined(ESP32)
+    return ESP.getFreeHeap();
+  #elif defined(ARDUINO_ARCH_RP2040)
+    return rp2040.getFreeHeap();
+  #else
+    return -1;
+  #endif
+}
+
+// the update request of writeFields() with four fields
+void buildRequests()
+{
+  for(int c = 0; c < NUM_CHANNELS; c++)
+  {
+    sprintf(writeAPIKeys[c], "KEY%013d", c);
+    String body = "field1=23.45&field2=41&field3=1013.25&field4=";
+    body.concat(c);
+    body.concat("&headers=false");
+    requests[c] = "POST /update HTTP/1.1\r\nHost: api.thingspeak.com\r\nUser-Agent: tslib-arduino/" TS_VER "\r\nX-THINGSPEAKAPIKEY: ";
+    requests[c].concat(writeAPIKeys[c]);
+    requests[c].concat("\r\nContent-Type: application/x-www-form-urlencoded\r\nContent-Length: ");
+    requests[c].concat(body.length());
+    requests[c].concat("\r\n\r\n");
+    requests[c].concat(body);
+
+    channels[c].channelNumber = 1000 + c;
+    channels[c].writeAPIKey = writeAPIKeys[c];
+    channels[c].updates = updates[c];
+    channels[c].capacity = QUEUE_SIZE;
+  }
+}
+
+void runBenchmark(unsigned int numDevices)
+{
+  ThingSpeak.setGatewayChannels(channels, NUM_CHANNELS, 0);
+  upstream.resetCounters();
+
+  unsigned long totalAck = 0;
+  unsigned long maxAck = 0;
+  unsigned int rejected = 0;
+  long heapBefore = freeHeap();
+  unsigned long start = micros();
+  for(unsigned int d = 0; d < numDevices; d++)
+  {
+    String & request = requests[d % NUM_CHANNELS];
+    device.setResponse(request.c_str(), request.length());
+    device.connect("relay", 80);
+    unsigned long ackStart = micros();
+    if(relayHandleRequest(device, channels, NUM_CHANNELS) != TS_OK_SUCCESS) rejected++;
+    unsigned long ack = micros() - ackStart;
+    device.stop();
+    totalAck += ack;
+    if(ack > maxAck) maxAck = ack;
+  }
+  unsigned long bulkUpdates = 0;
+  while(ThingSpeak.serviceGateway() != TS_ERR_QUEUE_EMPTY)
+  {
+    bulkUpdates++;
+  }
+  unsigned long elapsed = micros() - start;
+  long heapAfter = freeHeap();
+
+  Serial.print("devices "); Serial.print(numDevices);
+  Serial.print(": ack us avg "); Serial.print(totalAck / numDevices);
+  Serial.print(" max "); Serial.print(maxAck);
+  Serial.print(", updates/s "); Serial.print(1000000.0 * numDevices / (elapsed > 0 ? elapsed : 1), 1);
+  Serial.print(", bulk updates "); Serial.print(bulkUpdates);
+  Serial.print(", connects "); Serial.print(upstream.connects);
+  Serial.print(", rejected "); Serial.print(rejected);
+  Serial.print(", heap change ");
+  if(heapBefore < 0) Serial.println("n/a");
+  else Serial.println(heapAfter - heapBefore);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while(!Serial); // for the Arduino Leonardo/Micro only
+
+  buildRequests();
+  upstream.setResponse(bulkResponse, sizeof(bulkResponse) - 1);
+  upstream.setConnectDelay(CONNECT_DELAY_US);
+  upstream.setArrivalDelay(ARRIVAL_DELAY_US);
+  ThingSpeak.begin(upstream);
+  ThingSpeak.setKeepAlive(true);
+
+  for(size_t i = 0; i < sizeof(deviceCounts) / sizeof(deviceCounts[0]); i++)
+  {
+    runBenchmark(deviceCounts[i]);
+  }
+}
+
+void loop()
+{
+}
@@ -0,0 +1,105 @@
+/*
+  benchTransport
+
+  Compares the clients the library can use on an ESP32 for HTTPS: WiFiClientSecure and
+  ThingSpeakESP32Client (esp-tls with a receive buffer and TLS session resumption), each with and
+  without keep-alive.  Every case reads the last entry ID of the MathWorks weather station channel
+  NUM_REQUESTS times.
+
+  Prints, for each case, the requests per second, the failed requests, the responses that came back
+  with an entry ID older than the first one read (a corrupted response), the free heap after the run
+  and the lowest free heap seen since boot.  Run the cases on the same network, one after the other,
+  as the round trip to the server dominates the numbers.
+
+  Hardware: ESP32 based boards
+
+  !!! IMPORTANT - Modify the secrets.h file for this project with your network connection details. !!!
+
+  Note:
+  - Requires installation of EPS32 core. See https://github.com/espressif/arduino-esp32/blob/master/docs/arduino-ide/boards_manager.md for details.
+  - Select the target hardware from the Tools->Board menu
+
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.
+
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+
+  For licensing information, see the accompanying license file.
+
+  Copyright 2020-2025, The MathWorks, Inc.
+*/
+
+#define TS_ENABLE_SSL // For HTTPS SSL connection
+
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include "ThingSpeakESP32Client.h"
+#include "secrets.h"
+#include "ThingSpeak.h" // always include thingspeak header file after other header files and custom macros
+
+#define NUM_REQUESTS 20
+
+char ssid[] = SECRET_SSID;   // your network SSID (name)
+char pass[] = SECRET_PASS;   // your network password
+
+const char * certificate = SECRET_TS_ROOT_CA;
+unsigned long weatherStationChannelNumber = SECRET_CH_ID_WEATHER_STATION;
+
+WiFiClientSecure secureClient;
+ThingSpeakESP32Client espClient;
+
+void runBenchmark(const char * name, Client & client, bool keepAlive)
+{
+  ThingSpeak.begin(client);
+  ThingSpeak.setKeepAlive(keepAlive);
+  long firstEntryID = ThingSpeak.readLastEntryID(weatherStationChannelNumber); // warm up, connects and resolves the host
+
+  int failed = 0;
+  int corrupted = 0;
+  unsigned long start = millis();
+  for(int i = 0; i < NUM_REQUESTS; i++)
+  {
+    long entryID = ThingSpeak.readLastEntryID(weatherStationChannelNumber);
+    if(ThingSpeak.getLastReadStatus() != TS_OK_SUCCESS) failed++;
+    else if(entryID < firstEntryID) corrupted++;
+  }
+  unsigned long elapsed = millis() - start;
+  client.stop();
+
+  Serial.print(name);
+  Serial.print(": requests/s "); Serial.print(1000.0 * NUM_REQUESTS / (elapsed > 0 ? elapsed : 1), 2);
+  Serial.print(", failed "); Serial.print(failed);
+  Serial.print(", corrupted "); Serial.print(corrupted);
+  Serial.print(", free heap "); Serial.print(ESP.getFreeHeap());
+  Serial.print(", min free heap "); Serial.println(ESP.getMinFreeHeap());
+}
+
+void setup()
+{
+  Serial.begin(115200);  //Initialize serial
+  while (!Serial) {
+    ; // wait for serial port to connect. Needed for Leonardo native USB port only
+  }
+
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(ssid, pass);
+  while(WiFi.status() != WL_CONNECTED)
+  {
+    delay(500);
+    Serial.print(".");
+  }
+  Serial.println("\nConnected.");
+
+  secureClient.setCACert(certificate); // Set Root Certificate for authenticity check
+  espClient.setCACert(certificate);
+
+  runBenchmark("WiFiClientSecure                ", secureClient, false);
+  runBenchmark("WiFiClientSecure keep-alive     ", secureClient, true);
+  runBenchmark("ThingSpeakESP32Client           ", espClient, false);
+  runBenchmark("ThingSpeakESP32Client keep-alive", espClient, true);
+}
+
+void loop()
+{
+}
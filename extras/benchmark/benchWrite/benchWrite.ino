@@ -0,0 +1,146 @@
+/*
+  benchWrite
+
+  Measures the write path of the library: the setField() overloads, captureField() and
+  stageCapturedFields(), and writeField()/writeFields() including the Content-Length computation and
+  the serialization of the request.  The requests go to a
+  ReplayClient that counts what is written and answers with a recorded response, so the numbers show
+  the cost on this board without network latency.
+
+  The writes are measured with and without a prepared request header (setRequestHeaderCache()).
+
+  Prints, for each case, the average time per operation in nanoseconds, the bytes and write() calls
+  the client received per operation, and the change in free heap over all repeats (leaks show up as a
+  negative number, "n/a" on boards without a free heap query).
+
+  Run it before and after a change to the library and compare the numbers.
+
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.
+
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+
+  For licensing information, see the accompanying license file.
+
+  Copyright 2020-2025, The MathWorks, Inc.
+*/
+
+#include "ThingSpeakReplayClient.h"
+#include "ThingSpeak.h" // always include thingspeak header file after other header files and custom macros
+
+#define NUM_REPEATS 200
+
+const char writeResponse[] = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 1\r\n\r\n1";
+
+ReplayClient client;
+unsigned long channelNumber = 1;
+const char * writeAPIKey = "XXXXXXXXXXXXXXXX";
+String longString;
+requestHeader headers[1];
+capturedSample samples[9];
+
+long freeHeap()
+{
+  #if defined(ESP8266) || defined(ESP32)
+    return ESP.getFreeHeap();
+  #elif defined(ARDUINO_ARCH_RP2040)
+    return rp2040.getFreeHeap();
+  #else
+    return -1;
+  #endif
+}
+
+void setInt1()    { ThingSpeak.setField(1, 1234); }
+void setInt8()    { for(unsigned int f = 1; f <= 8; f++) ThingSpeak.setField(f, (int)(1000 + f)); }
+void setLong8()   { for(unsigned int f = 1; f <= 8; f++) ThingSpeak.setField(f, (long)(2000000000L + f)); }
+void setFloat8()  { for(unsigned int f = 1; f <= 8; f++) ThingSpeak.setField(f, (float)(23.45 * f)); }
+void setString8() { for(unsigned int f = 1; f <= 8; f++) ThingSpeak.setField(f, longString); }
+
+// what an interrupt pays for 8 values (the buffer is emptied again by setCaptureBuffer()), and what loop() pays to format them
+void captureInt8()   { for(unsigned int f = 1; f <= 8; f++) ThingSpeak.captureField(f, (long)(1000 + f)); ThingSpeak.setCaptureBuffer(samples, 9); }
+void captureFloat8() { for(unsigned int f = 1; f <= 8; f++) ThingSpeak.captureField(f, (float)(23.45 * f)); ThingSpeak.setCaptureBuffer(samples, 9); }
+void stageInt8()     { for(unsigned int f = 1; f <= 8; f++) ThingSpeak.captureField(f, (long)(1000 + f)); ThingSpeak.stageCapturedFields(); }
+
+void writeInt1()    { setInt1(); ThingSpeak.writeFields(channelNumber, writeAPIKey); }
+void writeInt8()    { setInt8(); ThingSpeak.writeFields(channelNumber, writeAPIKey); }
+void writeLong8()   { setLong8(); ThingSpeak.writeFields(channelNumber, writeAPIKey); }
+void writeFloat8()  { setFloat8(); ThingSpeak.writeFields(channelNumber, writeAPIKey); }
+void writeString8() { setString8(); ThingSpeak.writeFields(channelNumber, writeAPIKey); }
+
+void writeFieldInt()    { ThingSpeak.writeField(channelNumber, 1, 1234, writeAPIKey); }
+void writeFieldLong()   { ThingSpeak.writeField(channelNumber, 1, 2000000001L, writeAPIKey); }
+void writeFieldFloat()  { ThingSpeak.writeField(channelNumber, 1, 23.45f, writeAPIKey); }
+void writeFieldString() { ThingSpeak.writeField(channelNumber, 1, longString, writeAPIKey); }
+
+// setField() alone keeps the values, clear them with a write that goes nowhere
+void clearFields()
+{
+  client.setResponse(writeResponse, sizeof(writeResponse) - 1);
+  ThingSpeak.writeFields(channelNumber, writeAPIKey);
+}
+
+void runBenchmark(const char * name, void (*operation)(), bool writes)
+{
+  client.setResponse(writeResponse, sizeof(writeResponse) - 1);
+  operation(); // warm up, so that String buffers of the library are already allocated
+  if(!writes) clearFields();
+  client.resetCounters();
+
+  long heapBefore = freeHeap();
+  unsigned long start = micros();
+  for(int i = 0; i < NUM_REPEATS; i++)
+  {
+    operation();
+  }
+  unsigned long elapsed = micros() - start;
+  long heapAfter = freeHeap();
+
+  Serial.print(name);
+  Serial.print(": ns/op "); Serial.print((unsigned long)((1000.0 * elapsed) / NUM_REPEATS));
+  Serial.print(", bytes/op "); Serial.print(client.bytesWritten / NUM_REPEATS);
+  Serial.print(", writes/op "); Serial.print(client.writeCalls / NUM_REPEATS);
+  Serial.print(", heap change ");
+  if(heapBefore < 0) Serial.println("n/a");
+  else Serial.println(heapAfter - heapBefore);
+
+  if(!writes) clearFields();
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while(!Serial); // for the Arduino Leonardo/Micro only
+
+  for(int i = 0; i < 64; i++) longString.concat((char)('a' + i % 26));
+  ThingSpeak.begin(client);
+  ThingSpeak.setCaptureBuffer(samples, 9);
+
+  runBenchmark("setField int x1          ", setInt1, false);
+  runBenchmark("setField int x8          ", setInt8, false);
+  runBenchmark("setField long x8         ", setLong8, false);
+  runBenchmark("setField float x8        ", setFloat8, false);
+  runBenchmark("setField String(64) x8   ", setString8, false);
+  runBenchmark("captureField long x8     ", captureInt8, false);
+  runBenchmark("captureField float x8    ", captureFloat8, false);
+  runBenchmark("stageCapturedFields x8   ", stageInt8, false);
+  runBenchmark("writeFields int x1       ", writeInt1, true);
+  runBenchmark("writeFields int x8       ", writeInt8, true);
+  runBenchmark("writeFields long x8      ", writeLong8, true);
+  runBenchmark("writeFields float x8     ", writeFloat8, true);
+  runBenchmark("writeFields String(64) x8", writeString8, true);
+  runBenchmark("writeField int           ", writeFieldInt, true);
+  runBenchmark("writeField long          ", writeFieldLong, true);
+  runBenchmark("writeField float         ", writeFieldFloat, true);
+  runBenchmark("writeField String(64)    ", writeFieldString, true);
+
+  // the same writes with the request header prepared once
+  ThingSpeak.setRequestHeaderCache(headers, 1);
+  runBenchmark("cached writeFields int x1", writeInt1, true);
+  runBenchmark("cached writeFields int x8", writeInt8, true);
+  runBenchmark("cached writeField int    ", writeFieldInt, true);
+}
+
+void loop()
+{
+}
@@ -70,6 +70,28 @@ test(beginCase)
   assertEqual(TS_OK_SUCCESS, ThingSpeak.writeField(testChannelNumber, FIELD1, val, testChannelWriteAPIKey));
 }
 
+/* This test case checks for the following:
+    - begin with a custom server that does not exist
+    - begin with the host name and port of ThingSpeak, with and without a path prefix
+*/
+test(beginEndpointCase)
+{
+  int val = 26;
+
+  assertTrue(ThingSpeak.begin(client, "thingspeak.invalid", 80));
+  assertEqual(TS_ERR_CONNECT_FAILED, ThingSpeak.writeField(testChannelNumber, FIELD1, val, testChannelWriteAPIKey));
+
+  // Always wait to ensure that rate limit isn't hit
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertTrue(ThingSpeak.begin(client, "api.thingspeak.com", 80));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeField(testChannelNumber, FIELD1, val, testChannelWriteAPIKey));
+
+  assertTrue(ThingSpeak.begin(client, "api.thingspeak.com", 80, "/nothing", NULL));
+  assertEqual(TS_ERR_BADURL, ThingSpeak.writeField(testChannelNumber, FIELD1, val, testChannelWriteAPIKey));
+
+  ThingSpeak.begin(client);
+}
+
 void setup()
 {
   Serial.begin(9600);
@@ -0,0 +1,126 @@
+#line 2 "testChannelInfo.ino"
+/*
+  testChannelInfo unit test
+  
+  Unit Test for the channel description functions (readChannelInfo, setChannelInfo) in the ThingSpeak Communication Library for Arduino
+  
+  This test use the ArduinoUnit 2.1.0 unit test framework.  Visit https://github.com/mmurdoch/arduinounit to learn more.
+  
+  ArduinoUnit does not support ESP8266 or ESP32 and therefor these tests will not compile for those platforms.
+  
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and 
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.  
+  
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+  
+  For licensing information, see the accompanying license file.
+  
+  Copyright 2020-2025, The MathWorks, Inc.
+*/
+
+//#define USE_WIFI101_SHIELD
+//#define USE_ETHERNET_SHIELD
+
+#if !defined(USE_WIFI101_SHIELD) && !defined(USE_ETHERNET_SHIELD) && !defined(ARDUINO_SAMD_MKR1000) && !defined(ARDUINO_AVR_YUN)
+  #error "Uncomment the #define for either USE_WIFI101_SHIELD or USE_ETHERNET_SHIELD"
+#endif
+
+#include <ArduinoUnit.h>
+
+#if defined(ARDUINO_AVR_YUN)
+    #include "YunClient.h"
+    YunClient client;
+#else
+  #if defined(USE_WIFI101_SHIELD) || defined(ARDUINO_SAMD_MKR1000)
+    // Use WiFi  
+    #include <SPI.h>
+    #include <WiFi101.h>
+    char ssid[] = "<YOURNETWORK>";    //  your network SSID (name) 
+    char pass[] = "<YOURPASSWORD>";   // your network password   
+    int status = WL_IDLE_STATUS;
+    WiFiClient  client;
+  #elif defined(USE_ETHERNET_SHIELD)
+    // Use wired ethernet shield
+    #include <SPI.h>
+    #include <Ethernet.h>
+    byte mac[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED};
+    EthernetClient client;
+  #endif
+#endif
+
+#include <ThingSpeak.h> // always include thingspeak header file after other header files and custom macros
+
+unsigned long testPublicChannelNumber = 12397;
+unsigned long testPrivateChannelNumber = 1070863;
+const char * testPrivateChannelReadAPIKey = "I0QKRG8MU0HEFKYQ";
+
+channelInfo info;
+
+/* This test case checks for the following:
+    - channel description of a public channel
+    - channel description of a private channel, with and without the read API key
+    - read of a channel that doesn't exist
+*/
+test(readChannelInfoCase)
+{
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.readChannelInfo(testPublicChannelNumber, info));
+  assertEqual(CHANNELINFO_VERSION, info.version);
+  assertEqual(testPublicChannelNumber, (unsigned long)info.channelNumber);
+  assertTrue(strlen(info.name) > 0);
+  assertTrue(info.activeFields & 0x01);
+  assertTrue(strlen(info.fieldLabel[0]) > 0);
+  assertTrue(info.lastEntryID > 0);
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.readChannelInfo(testPrivateChannelNumber, info, testPrivateChannelReadAPIKey));
+  assertEqual(CHANNELINFO_VERSION, info.version);
+  assertTrue(info.activeFields & 0x01);
+
+  assertNotEqual(TS_OK_SUCCESS, ThingSpeak.readChannelInfo(testPrivateChannelNumber, info));
+  assertNotEqual(TS_OK_SUCCESS, ThingSpeak.readChannelInfo(0, info));
+}
+
+/* This test case checks for the following:
+    - setField() against a channel description
+    - record that is not valid
+*/
+test(setChannelInfoCase)
+{
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.readChannelInfo(testPrivateChannelNumber, info, testPrivateChannelReadAPIKey));
+  assertTrue(ThingSpeak.setChannelInfo(&info));
+  for(unsigned int field = 1; field <= 8; field++)
+  {
+    bool active = info.activeFields & (1 << (field - 1));
+    assertEqual(active, ThingSpeak.isFieldActive(field));
+    assertEqual(active ? TS_OK_SUCCESS : TS_ERR_INVALID_FIELD_NUM, ThingSpeak.setField(field, (int)field));
+  }
+
+  info.version = 0;
+  assertFalse(ThingSpeak.setChannelInfo(&info));
+  assertTrue(ThingSpeak.isFieldActive(8));
+  assertEqual(TS_ERR_INVALID_FIELD_NUM, ThingSpeak.setField(9, 1));
+
+  ThingSpeak.setChannelInfo(NULL);
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  while(!Serial); // for the Arduino Leonardo/Micro only
+  Serial.println("Starting test...");
+  #ifdef ARDUINO_AVR_YUN
+    Bridge.begin();
+  #else   
+    #if defined(USE_WIFI101_SHIELD) || defined(ARDUINO_SAMD_MKR1000)
+      WiFi.begin(ssid, pass);
+    #else
+      Ethernet.begin(mac);
+    #endif
+  #endif
+  ThingSpeak.begin(client);
+}
+
+void loop()
+{
+  Test::run();
+}
@@ -0,0 +1,306 @@
+#line 2 "testQueuedWrite.ino"
+/*
+  testQueuedWrite unit test
+  
+  Unit Test for the update queue (setUpdateQueue, queueFields, writeQueuedFields, queueUrgentFields, serviceUpdateQueue, setQueueOverflow) and gateway mode (setGatewayChannels, queueChannelFields, serviceGateway) in the ThingSpeak Communication Library for Arduino
+  
+  This test use the ArduinoUnit 2.1.0 unit test framework.  Visit https://github.com/mmurdoch/arduinounit to learn more.
+  
+  ArduinoUnit does not support ESP8266 or ESP32 and therefor these tests will not compile for those platforms.
+  
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and 
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.  
+  
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+  
+  For licensing information, see the accompanying license file.
+  
+  Copyright 2020-2025, The MathWorks, Inc.
+*/
+
+//#define USE_WIFI101_SHIELD
+//#define USE_ETHERNET_SHIELD
+
+#if !defined(USE_WIFI101_SHIELD) && !defined(USE_ETHERNET_SHIELD) && !defined(ARDUINO_SAMD_MKR1000) && !defined(ARDUINO_AVR_YUN)
+  #error "Uncomment the #define for either USE_WIFI101_SHIELD or USE_ETHERNET_SHIELD"
+#endif
+
+#include <ArduinoUnit.h>
+
+#if defined(ARDUINO_AVR_YUN)
+    #include "YunClient.h"
+    YunClient client;
+#else
+  #if defined(USE_WIFI101_SHIELD) || defined(ARDUINO_SAMD_MKR1000)
+    // Use WiFi  
+    #include <SPI.h>
+    #include <WiFi101.h>
+    char ssid[] = "<YOURNETWORK>";    //  your network SSID (name) 
+    char pass[] = "<YOURPASSWORD>";   // your network password   
+    int status = WL_IDLE_STATUS;
+    WiFiClient  client;
+  #elif defined(USE_ETHERNET_SHIELD)
+    // Use wired ethernet shield
+    #include <SPI.h>
+    #include <Ethernet.h>
+    byte mac[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED};
+    EthernetClient client;
+  #endif
+#endif
+
+#include <ThingSpeak.h> // always include thingspeak header file after other header files and custom macros
+
+unsigned long testChannelNumber = 1070863;
+const char * testChannelWriteAPIKey = "UI7FSU4O8ZJ5BM8O";
+const char * testChannelReadAPIKey = "I0QKRG8MU0HEFKYQ";
+
+#define WRITE_DELAY_FOR_THINGSPEAK 15000 // Data write limit for a free user (15 sec).
+
+#define QUEUE_SIZE 3
+
+queuedUpdate updates[QUEUE_SIZE];
+queuedUpdate channelUpdates[QUEUE_SIZE];
+gatewayChannel channels[1];
+queuedUpdate backfillRows[QUEUE_SIZE];
+
+// Stream that reads a log from a string, in place of a file on an SD card
+class LogStream : public Stream
+{
+  public:
+    LogStream(const char * text) : text(text), pos(0) {}
+    int available() { return strlen(text + pos); }
+    int read() { return (text[pos] != 0) ? text[pos++] : -1; }
+    int peek() { return (text[pos] != 0) ? text[pos] : -1; }
+    size_t write(uint8_t c) { return 0; }
+    const char * text;
+    size_t pos;
+};
+
+/* This test case checks for the following:
+    - queue without storage
+    - queue without fields set
+    - oldest update is dropped when the queue is full
+    - bulk write of the queued updates
+    - write of an empty queue
+*/
+test(queueFieldsCase)
+{
+  ThingSpeak.setUpdateQueue(NULL, 0);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(1, 1));
+  assertEqual(TS_ERR_QUEUE_EMPTY, ThingSpeak.queueFields());
+
+  ThingSpeak.setUpdateQueue(updates, QUEUE_SIZE);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.queueFields());
+  assertEqual(TS_ERR_SETFIELD_NOT_CALLED, ThingSpeak.queueFields());
+  ThingSpeak.setUpdateQueue(updates, QUEUE_SIZE);
+
+  for(int i = 0; i < QUEUE_SIZE + 1; i++)
+  {
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(1, i));
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(2, (float)(i + 0.5)));
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.queueFields());
+    delay(1000);
+  }
+  assertEqual((unsigned int)QUEUE_SIZE, ThingSpeak.getQueuedCount());
+  assertEqual(1UL, ThingSpeak.getQueueDropped());
+
+  // Always wait to ensure that rate limit isn't hit
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeQueuedFields(testChannelNumber, testChannelWriteAPIKey));
+  assertEqual(0U, ThingSpeak.getQueuedCount());
+  assertEqual(TS_ERR_QUEUE_EMPTY, ThingSpeak.writeQueuedFields(testChannelNumber, testChannelWriteAPIKey));
+
+  // The bulk update is processed by ThingSpeak in the background
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(QUEUE_SIZE, ThingSpeak.readIntField(testChannelNumber, 1, testChannelReadAPIKey));
+  assertEqual((float)(QUEUE_SIZE + 0.5), ThingSpeak.readFloatField(testChannelNumber, 2, testChannelReadAPIKey));
+
+  ThingSpeak.setUpdateQueue(NULL, 0);
+}
+
+/* This test case checks for the following:
+    - unknown overflow policy and decimation mode
+    - full queue is decimated instead of dropping updates
+    - merged updates keep the mean, the largest or the smallest value
+    - coverage and decimation of the queue
+*/
+test(queueDecimationCase)
+{
+  assertEqual(TS_ERR_OUT_OF_RANGE, ThingSpeak.setQueueOverflow(-1));
+  assertEqual(TS_ERR_INVALID_FIELD_NUM, ThingSpeak.setFieldDecimation(0, TS_DECIMATE_MAX));
+  assertEqual(TS_ERR_OUT_OF_RANGE, ThingSpeak.setFieldDecimation(2, -1));
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setQueueOverflow(TS_QUEUE_DECIMATE));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setFieldDecimation(2, TS_DECIMATE_MAX));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setFieldDecimation(3, TS_DECIMATE_MIN));
+  ThingSpeak.setUpdateQueue(updates, QUEUE_SIZE);
+  for(int i = 0; i < QUEUE_SIZE + 1; i++)
+  {
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(1, i));
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(2, i));
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(3, i));
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.queueFields());
+    delay(1000);
+  }
+  assertEqual((unsigned int)QUEUE_SIZE, ThingSpeak.getQueuedCount());
+  assertEqual(0UL, ThingSpeak.getQueueDropped());
+  assertEqual(2U, ThingSpeak.getQueueDecimation());
+  assertMoreOrEqual(ThingSpeak.getQueueCoverage(), (QUEUE_SIZE - 1) * 1000UL);
+
+  // the two oldest updates were merged
+  assertEqual(0.5f, updates[1].field[0]);
+  assertEqual(1.0f, updates[1].field[1]);
+  assertEqual(0.0f, updates[1].field[2]);
+  assertEqual(2, updates[1].samples);
+
+  ThingSpeak.setFieldDecimation(2, TS_DECIMATE_MEAN);
+  ThingSpeak.setFieldDecimation(3, TS_DECIMATE_MEAN);
+  ThingSpeak.setQueueOverflow(TS_QUEUE_DROP_OLDEST);
+  ThingSpeak.setUpdateQueue(NULL, 0);
+}
+
+/* This test case checks for the following:
+    - gateway without channels
+    - queue on a channel that is not a gateway channel
+    - bulk write of the queued updates of a gateway channel
+    - channel is not written again before the interval has passed
+*/
+test(gatewayCase)
+{
+  assertEqual(TS_ERR_QUEUE_EMPTY, ThingSpeak.serviceGateway());
+
+  channels[0].channelNumber = testChannelNumber;
+  channels[0].writeAPIKey = testChannelWriteAPIKey;
+  channels[0].updates = channelUpdates;
+  channels[0].capacity = QUEUE_SIZE;
+  ThingSpeak.setGatewayChannels(channels, 1, WRITE_DELAY_FOR_THINGSPEAK);
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(1, 1));
+  assertEqual(TS_ERR_QUEUE_EMPTY, ThingSpeak.queueChannelFields(testChannelNumber + 1));
+  for(int i = 0; i < QUEUE_SIZE; i++)
+  {
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(1, 10 + i));
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.queueChannelFields(testChannelNumber));
+    delay(1000);
+  }
+  assertEqual((unsigned long)QUEUE_SIZE, ThingSpeak.getGatewayQueuedCount());
+
+  // Always wait to ensure that rate limit isn't hit
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.serviceGateway());
+  assertEqual(testChannelNumber, ThingSpeak.getGatewayChannel());
+  assertEqual(0UL, ThingSpeak.getGatewayQueuedCount());
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(1, 20));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.queueChannelFields(testChannelNumber));
+  assertEqual(TS_ERR_QUEUE_EMPTY, ThingSpeak.serviceGateway());
+
+  // The bulk update is processed by ThingSpeak in the background
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(9 + QUEUE_SIZE, ThingSpeak.readIntField(testChannelNumber, 1, testChannelReadAPIKey));
+
+  ThingSpeak.setGatewayChannels(NULL, 0);
+}
+
+/* This test case checks for the following:
+    - rows of a log are written with one bulk update
+    - header line is skipped
+    - checkpoint is moved to the end of the written rows
+    - log is done once all rows are written
+*/
+test(backfillCase)
+{
+  const char * log = "created_at,field1,field2\n2024-03-01 12:00:00,30,30.5\n1709294460,31,\n2024-03-01T12:02:00Z,32,32.5\n";
+  LogStream stream(log);
+  backfillJob job = { testChannelNumber, testChannelWriteAPIKey, backfillRows, QUEUE_SIZE };
+  ThingSpeak.beginBackfill(job, WRITE_DELAY_FOR_THINGSPEAK);
+
+  // Always wait to ensure that rate limit isn't hit
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.serviceBackfill(job, stream));
+  assertEqual(3UL, job.rowsWritten);
+  assertEqual(1UL, job.rowsSkipped);
+  assertEqual((uint32_t)strlen(log), job.offset);
+  assertEqual(TS_ERR_QUEUE_EMPTY, ThingSpeak.serviceBackfill(job, stream));
+  assertTrue(ThingSpeak.isBackfillDone(job));
+}
+
+/* This test case checks for the following:
+    - zone offsets with and without a colon between hours and minutes
+    - row with an offset that cannot be read is skipped
+*/
+test(backfillZoneCase)
+{
+  const char * log = "created_at,field1\n2024-03-01 17:33:00+05:30,40\n2024-03-01 07:04:00-0500,41\n2024-03-01 12:05:00+5,42\n";
+  LogStream stream(log);
+  backfillJob job = { testChannelNumber, testChannelWriteAPIKey, backfillRows, QUEUE_SIZE };
+  ThingSpeak.beginBackfill(job, WRITE_DELAY_FOR_THINGSPEAK);
+
+  // Always wait to ensure that rate limit isn't hit
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.serviceBackfill(job, stream));
+  assertEqual(2UL, job.rowsWritten);
+  assertEqual(2UL, job.rowsSkipped);
+
+  // The bulk update is processed by ThingSpeak in the background
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(String("2024-03-01T12:04:00Z"), ThingSpeak.readCreatedAt(testChannelNumber, testChannelReadAPIKey));
+}
+
+/* This test case checks for the following:
+    - urgent update without values
+    - urgent update is sent before the queued updates, with its status
+    - queued updates are sent in the next slot
+    - nothing is sent before the interval has passed
+*/
+test(urgentLaneCase)
+{
+  assertEqual(TS_ERR_SETFIELD_NOT_CALLED, ThingSpeak.queueUrgentFields());
+
+  ThingSpeak.setUpdateQueue(updates, QUEUE_SIZE, WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(1, 1));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.queueFields());
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(3, 7));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setStatus("alarm"));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.queueUrgentFields());
+  assertTrue(ThingSpeak.isUrgentPending());
+
+  // Always wait to ensure that rate limit isn't hit
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.serviceUpdateQueue(testChannelNumber, testChannelWriteAPIKey));
+  assertFalse(ThingSpeak.isUrgentPending());
+  assertEqual(1U, ThingSpeak.getQueuedCount());
+  assertEqual(TS_ERR_QUEUE_EMPTY, ThingSpeak.serviceUpdateQueue(testChannelNumber, testChannelWriteAPIKey));
+  assertEqual(7, ThingSpeak.readIntField(testChannelNumber, 3, testChannelReadAPIKey));
+  assertEqual(String("alarm"), ThingSpeak.readStatus(testChannelNumber, testChannelReadAPIKey));
+
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.serviceUpdateQueue(testChannelNumber, testChannelWriteAPIKey));
+  assertEqual(0U, ThingSpeak.getQueuedCount());
+  assertMore(ThingSpeak.getLaneLatency(TS_LANE_BULK), ThingSpeak.getLaneLatency(TS_LANE_URGENT));
+
+  ThingSpeak.setUpdateQueue(NULL, 0);
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  while(!Serial); // for the Arduino Leonardo/Micro only
+  Serial.println("Starting test...");
+  #ifdef ARDUINO_AVR_YUN
+    Bridge.begin();
+  #else   
+    #if defined(USE_WIFI101_SHIELD) || defined(ARDUINO_SAMD_MKR1000)
+      WiFi.begin(ssid, pass);
+    #else
+      Ethernet.begin(mac);
+    #endif
+  #endif
+  ThingSpeak.begin(client);
+}
+
+void loop()
+{
+  Test::run();
+}
@@ -0,0 +1,122 @@
+#line 2 "testReadCache.ino"
+/*
+  testReadCache unit test
+  
+  Unit Test for the read cache (setReadCache, getReadCacheHits, getReadCacheMisses) in the ThingSpeak Communication Library for Arduino
+  
+  This test use the ArduinoUnit 2.1.0 unit test framework.  Visit https://github.com/mmurdoch/arduinounit to learn more.
+  
+  ArduinoUnit does not support ESP8266 or ESP32 and therefor these tests will not compile for those platforms.
+  
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and 
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.  
+  
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+  
+  For licensing information, see the accompanying license file.
+  
+  Copyright 2020-2025, The MathWorks, Inc.
+*/
+
+//#define USE_WIFI101_SHIELD
+//#define USE_ETHERNET_SHIELD
+
+#if !defined(USE_WIFI101_SHIELD) && !defined(USE_ETHERNET_SHIELD) && !defined(ARDUINO_SAMD_MKR1000) && !defined(ARDUINO_AVR_YUN)
+  #error "Uncomment the #define for either USE_WIFI101_SHIELD or USE_ETHERNET_SHIELD"
+#endif
+
+#include <ArduinoUnit.h>
+
+#if defined(ARDUINO_AVR_YUN)
+    #include "YunClient.h"
+    YunClient client;
+#else
+  #if defined(USE_WIFI101_SHIELD) || defined(ARDUINO_SAMD_MKR1000)
+    // Use WiFi  
+    #include <SPI.h>
+    #include <WiFi101.h>
+    char ssid[] = "<YOURNETWORK>";    //  your network SSID (name) 
+    char pass[] = "<YOURPASSWORD>";   // your network password   
+    int status = WL_IDLE_STATUS;
+    WiFiClient  client;
+  #elif defined(USE_ETHERNET_SHIELD)
+    // Use wired ethernet shield
+    #include <SPI.h>
+    #include <Ethernet.h>
+    byte mac[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED};
+    EthernetClient client;
+  #endif
+#endif
+
+#include <ThingSpeak.h> // always include thingspeak header file after other header files and custom macros
+
+unsigned long testPrivateChannelNumber = 209615;
+const char * testPrivateChannelReadAPIKey = "D3MJBCYVNFX4Z2A8";
+const char * testPrivateChannelWriteAPIKey = "KI8B7DJTWXLZ6EBV";
+
+#define WRITE_DELAY_FOR_THINGSPEAK 15000
+
+readCacheEntry cacheEntries[2];
+
+test(readCacheHitCase)
+{
+  ThingSpeak.setReadCache(cacheEntries, 2, 60000);
+
+  // First read goes to ThingSpeak, second one is answered from the cache
+  float firstRead = ThingSpeak.readFloatField(testPrivateChannelNumber, 1, testPrivateChannelReadAPIKey);
+  assertEqual(TS_OK_SUCCESS,ThingSpeak.getLastReadStatus());
+  assertEqual(0UL,ThingSpeak.getReadCacheHits());
+  assertEqual(1UL,ThingSpeak.getReadCacheMisses());
+
+  assertEqual(firstRead,ThingSpeak.readFloatField(testPrivateChannelNumber, 1, testPrivateChannelReadAPIKey));
+  assertEqual(TS_OK_SUCCESS,ThingSpeak.getLastReadStatus());
+  assertEqual(1UL,ThingSpeak.getReadCacheHits());
+  assertEqual(1UL,ThingSpeak.getReadCacheMisses());
+
+  // A different field is a different cache entry
+  ThingSpeak.readFloatField(testPrivateChannelNumber, 2, testPrivateChannelReadAPIKey);
+  assertEqual(1UL,ThingSpeak.getReadCacheHits());
+  assertEqual(2UL,ThingSpeak.getReadCacheMisses());
+
+  ThingSpeak.setReadCache(NULL, 0, 0);
+}
+
+test(readCacheWriteInvalidatesCase)
+{
+  ThingSpeak.setReadCache(cacheEntries, 2, 60000);
+
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeField(testPrivateChannelNumber, 1, 11, testPrivateChannelWriteAPIKey));
+  assertEqual(11,ThingSpeak.readIntField(testPrivateChannelNumber, 1, testPrivateChannelReadAPIKey));
+
+  // The write must drop the cached value, so the new value is read back
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeField(testPrivateChannelNumber, 1, 12, testPrivateChannelWriteAPIKey));
+  assertEqual(12,ThingSpeak.readIntField(testPrivateChannelNumber, 1, testPrivateChannelReadAPIKey));
+  assertEqual(0UL,ThingSpeak.getReadCacheHits());
+
+  ThingSpeak.setReadCache(NULL, 0, 0);
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  while(!Serial); // for the Arduino Leonardo/Micro only
+  Serial.println("Starting test...");
+  #ifdef ARDUINO_AVR_YUN
+    Bridge.begin();
+  #else   
+    #if defined(USE_WIFI101_SHIELD) || defined(ARDUINO_SAMD_MKR1000)
+      WiFi.begin(ssid, pass);
+    #else
+      Ethernet.begin(mac);
+    #endif
+  #endif
+  ThingSpeak.begin(client);
+}
+
+void loop()
+{
+  Test::run();
+}
@@ -0,0 +1,279 @@
+#line 2 "testReadFeed.ino"
+/*
+  testReadFeed unit test
+  
+  Unit Test for the readFeedColumns function in the ThingSpeak Communication Library for Arduino
+  
+  This test use the ArduinoUnit 2.1.0 unit test framework.  Visit https://github.com/mmurdoch/arduinounit to learn more.
+  
+  ArduinoUnit does not support ESP8266 or ESP32 and therefor these tests will not compile for those platforms.
+  
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and 
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.  
+  
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+  
+  For licensing information, see the accompanying license file.
+  
+  Copyright 2020-2025, The MathWorks, Inc.
+*/
+
+//#define USE_WIFI101_SHIELD
+//#define USE_ETHERNET_SHIELD
+
+#if !defined(USE_WIFI101_SHIELD) && !defined(USE_ETHERNET_SHIELD) && !defined(ARDUINO_SAMD_MKR1000) && !defined(ARDUINO_AVR_YUN)
+  #error "Uncomment the #define for either USE_WIFI101_SHIELD or USE_ETHERNET_SHIELD"
+#endif
+
+#include <ArduinoUnit.h>
+
+#if defined(ARDUINO_AVR_YUN)
+    #include "YunClient.h"
+    YunClient client;
+#else
+  #if defined(USE_WIFI101_SHIELD) || defined(ARDUINO_SAMD_MKR1000)
+    // Use WiFi  
+    #include <SPI.h>
+    #include <WiFi101.h>
+    char ssid[] = "<YOURNETWORK>";    //  your network SSID (name) 
+    char pass[] = "<YOURPASSWORD>";   // your network password   
+    int status = WL_IDLE_STATUS;
+    WiFiClient  client;
+  #elif defined(USE_ETHERNET_SHIELD)
+    // Use wired ethernet shield
+    #include <SPI.h>
+    #include <Ethernet.h>
+    byte mac[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED};
+    EthernetClient client;
+  #endif
+#endif
+
+#include <ThingSpeak.h> // always include thingspeak header file after other header files and custom macros
+
+unsigned long testPrivateChannelNumber = 1070863; // private channel number
+const char * testPrivateChannelWriteAPIKey = "UI7FSU4O8ZJ5BM8O"; // write API key for the private channel
+const char * testPrivateChannelReadAPIKey = "I0QKRG8MU0HEFKYQ"; // read API key for the private channel
+
+#define WRITE_DELAY_FOR_THINGSPEAK 15000 // Data write limit for a free user (15 sec).
+
+#define NUM_UPDATES 3
+
+float field1Values[NUM_UPDATES];
+float field2Values[NUM_UPDATES];
+uint32_t createdAtValues[NUM_UPDATES];
+uint32_t entryIDValues[NUM_UPDATES];
+
+/* This test case checks for the following:
+    - read the latest updates into columns
+    - updates are stored oldest first
+    - missing values are NAN
+    - fields without an array are skipped
+*/
+test(readFeedColumnsCase)
+{
+  feedColumns columns = {};
+  columns.createdAt = createdAtValues;
+  columns.entryID = entryIDValues;
+  columns.field[0] = field1Values;
+  columns.field[1] = field2Values;
+  columns.capacity = NUM_UPDATES;
+
+  for(int i = 0; i < NUM_UPDATES; i++)
+  {
+    // Always to ensure that rate limit isn't hit
+    delay(WRITE_DELAY_FOR_THINGSPEAK);
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.writeField(testPrivateChannelNumber, 1, (float)(i + 0.5), testPrivateChannelWriteAPIKey));
+  }
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.readFeedColumns(testPrivateChannelNumber, NUM_UPDATES, columns, testPrivateChannelReadAPIKey));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.getLastReadStatus());
+  assertEqual((unsigned int)NUM_UPDATES, columns.count);
+
+  for(int i = 0; i < NUM_UPDATES; i++)
+  {
+    assertEqual((float)(i + 0.5), field1Values[i]);
+    assertTrue(isnan(field2Values[i]));
+    if(i > 0)
+    {
+      assertEqual(entryIDValues[i - 1] + 1, entryIDValues[i]);
+      assertMoreOrEqual(createdAtValues[i], createdAtValues[i - 1] + 15);
+    }
+  }
+
+  // Asking for more than the capacity only fills the capacity
+  columns.capacity = 1;
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.readFeedColumns(testPrivateChannelNumber, NUM_UPDATES, columns, testPrivateChannelReadAPIKey));
+  assertEqual(1U, columns.count);
+  assertEqual((float)(NUM_UPDATES - 0.5), field1Values[0]);
+
+  // Invalid API key
+  assertEqual(TS_ERR_BADAPIKEY, ThingSpeak.readFeedColumns(testPrivateChannelNumber, 1, columns, "AFAKEAPIKEYFAKEX"));
+  assertEqual(0U, columns.count);
+}
+
+/* This test case checks for the following:
+    - the same updates are read in CSV and JSON format
+    - invalid feed format
+*/
+test(readFeedCSVCase)
+{
+  float csvField1Values[NUM_UPDATES];
+  uint32_t csvEntryIDValues[NUM_UPDATES];
+
+  feedColumns jsonColumns = {};
+  jsonColumns.createdAt = createdAtValues;
+  jsonColumns.entryID = entryIDValues;
+  jsonColumns.field[0] = field1Values;
+  jsonColumns.capacity = NUM_UPDATES;
+
+  feedColumns csvColumns = {};
+  csvColumns.entryID = csvEntryIDValues;
+  csvColumns.field[0] = csvField1Values;
+  csvColumns.capacity = NUM_UPDATES;
+
+  assertEqual(TS_ERR_OUT_OF_RANGE, ThingSpeak.setFeedFormat(2));
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setFeedFormat(TS_FEED_FORMAT_JSON));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.readFeedColumns(testPrivateChannelNumber, NUM_UPDATES, jsonColumns, testPrivateChannelReadAPIKey));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setFeedFormat(TS_FEED_FORMAT_CSV));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.readFeedColumns(testPrivateChannelNumber, NUM_UPDATES, csvColumns, testPrivateChannelReadAPIKey));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setFeedFormat(TS_FEED_FORMAT_JSON));
+
+  assertEqual(jsonColumns.count, csvColumns.count);
+  for(unsigned int i = 0; i < csvColumns.count; i++)
+  {
+    assertEqual(entryIDValues[i], csvEntryIDValues[i]);
+    assertEqual(field1Values[i], csvField1Values[i]);
+  }
+}
+
+// Print that counts the lines written to it
+class LineCounter : public Print
+{
+  public:
+    unsigned int lines = 0;
+    size_t write(uint8_t c)
+    {
+      if(c == '\n') lines++;
+      return 1;
+    }
+};
+
+/* This test case checks for the following:
+    - a new mirror copies the channel from its first entry
+    - the copy ends at the last entry of the channel
+    - a synced mirror appends nothing
+    - page without entryID or createdAt
+*/
+test(syncChannelMirrorCase)
+{
+  feedColumns page = {};
+  page.createdAt = createdAtValues;
+  page.field[0] = field1Values;
+  page.capacity = NUM_UPDATES;
+
+  channelMirror mirror = {};
+  LineCounter store;
+  assertEqual(TS_ERR_OUT_OF_RANGE, ThingSpeak.syncChannelMirror(testPrivateChannelNumber, mirror, page, store, testPrivateChannelReadAPIKey));
+  page.entryID = entryIDValues;
+
+  unsigned int calls = 0;
+  do
+  {
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.syncChannelMirror(testPrivateChannelNumber, mirror, page, store, testPrivateChannelReadAPIKey));
+    calls++;
+  }
+  while(!ThingSpeak.isChannelMirrorSynced(mirror) && calls < 1000);
+  assertTrue(ThingSpeak.isChannelMirrorSynced(mirror));
+  assertEqual(ThingSpeak.readLastEntryID(testPrivateChannelNumber, testPrivateChannelReadAPIKey), (long)mirror.lastEntryID);
+  assertMoreOrEqual(mirror.lastEntryID, store.lines); // entries deleted from the channel are not in the copy
+
+  unsigned int lines = store.lines;
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.syncChannelMirror(testPrivateChannelNumber, mirror, page, store, testPrivateChannelReadAPIKey));
+  assertEqual(0U, ThingSpeak.getMirrorAppended());
+  assertEqual(lines, store.lines);
+}
+
+// Client that passes everything on to another one, except that after markStale() it acts like a
+// connection the server has closed while it still looks open: requests are taken, no response comes
+class StaleClient : public Client
+{
+  public:
+    StaleClient(Client & inner) : inner(inner), stale(false) {}
+    void markStale() { stale = true; }
+
+    int connect(IPAddress ip, uint16_t port) { stale = false; return inner.connect(ip, port); }
+    int connect(const char * host, uint16_t port) { stale = false; return inner.connect(host, port); }
+    size_t write(uint8_t c) { return stale ? 1 : inner.write(c); }
+    size_t write(const uint8_t * buf, size_t size) { return stale ? size : inner.write(buf, size); }
+    int available() { return stale ? 0 : inner.available(); }
+    int read() { return stale ? -1 : inner.read(); }
+    int read(uint8_t * buf, size_t size) { return stale ? -1 : inner.read(buf, size); }
+    int peek() { return stale ? -1 : inner.peek(); }
+    void flush() { if(!stale) inner.flush(); }
+    void stop() { stale = false; inner.stop(); }
+    uint8_t connected() { return stale ? 1 : inner.connected(); }
+    operator bool() { return stale || inner; }
+
+  private:
+    Client & inner;
+    bool stale;
+};
+
+/* This test case checks for the following:
+    - reads on a connection opened by prepare() that the server has closed are sent again on a new connection
+*/
+test(staleConnectionCase)
+{
+  StaleClient staleClient(client);
+  ThingSpeak.begin(staleClient);
+
+  feedColumns columns = {};
+  columns.entryID = entryIDValues;
+  columns.field[0] = field1Values;
+  columns.capacity = NUM_UPDATES;
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.prepare());
+  staleClient.markStale();
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.readFeedColumns(testPrivateChannelNumber, 1, columns, testPrivateChannelReadAPIKey));
+  assertEqual(1U, columns.count);
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.prepare());
+  staleClient.markStale();
+  assertEqual((long)entryIDValues[0], ThingSpeak.readLastEntryID(testPrivateChannelNumber, testPrivateChannelReadAPIKey));
+
+  channelInfo info;
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.prepare());
+  staleClient.markStale();
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.readChannelInfo(testPrivateChannelNumber, info, testPrivateChannelReadAPIKey));
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.prepare());
+  staleClient.markStale();
+  assertNotEqual(String(""), ThingSpeak.readRaw(testPrivateChannelNumber, String("/feeds/last.txt"), testPrivateChannelReadAPIKey));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.getLastReadStatus());
+
+  ThingSpeak.begin(client);
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  while(!Serial); // for the Arduino Leonardo/Micro only
+  Serial.println("Starting test...");
+  #ifdef ARDUINO_AVR_YUN
+    Bridge.begin();
+  #else   
+    #if defined(USE_WIFI101_SHIELD) || defined(ARDUINO_SAMD_MKR1000)
+      WiFi.begin(ssid, pass);
+    #else
+      Ethernet.begin(mac);
+    #endif
+  #endif
+  ThingSpeak.begin(client);
+}
+
+void loop()
+{
+  Test::run();
+}
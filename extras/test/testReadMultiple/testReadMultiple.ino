@@ -497,6 +497,31 @@ test(readBasicCase)
     
     */
   }
+  
+  
+  /* This test case checks for the following:
+      - read the latest entry ID
+      - read multiple only when the entry ID advanced
+  */
+  test(readIfChangedCase)
+  {
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.readMultipleFields(testPrivateChannelNumber, testPrivateChannelReadAPIKey));
+    long entryID = ThingSpeak.getEntryID();
+    assertNotEqual(0L, entryID);
+    assertEqual(entryID, ThingSpeak.readLastEntryID(testPrivateChannelNumber, testPrivateChannelReadAPIKey));
+  
+    // Nothing was written in between
+    assertEqual(TS_OK_NOT_MODIFIED, ThingSpeak.readMultipleFieldsIfChanged(testPrivateChannelNumber, testPrivateChannelReadAPIKey));
+  
+    // Always wait 15 seconds to ensure that rate limit isn't hit
+    delay(WRITE_DELAY_FOR_THINGSPEAK);
+    
+    ThingSpeak.setField(FIELD1, 42);
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.writeFields(testPrivateChannelNumber, testPrivateChannelWriteAPIKey));
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.readMultipleFieldsIfChanged(testPrivateChannelNumber, testPrivateChannelReadAPIKey));
+    assertEqual(entryID + 1, ThingSpeak.getEntryID());
+    assertEqual(42, ThingSpeak.getFieldAsInt(FIELD1));
+  }
 
 #endif // Mega and MKR1000 only tests
 
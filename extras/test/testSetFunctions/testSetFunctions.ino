@@ -118,6 +118,142 @@ test(setFieldCase)
   assertEqual(TS_ERR_INVALID_FIELD_NUM,ThingSpeak.setField(FIELD9,floatVal)); 
 }
 
+uint32_t seriesClockSeconds = 0;
+uint32_t testSeriesClock()
+{
+  return seriesClockSeconds;
+}
+
+/* This test case checks for the following:
+    - setField records numeric values into the field history
+    - text values are not recorded
+    - the oldest sample is replaced when the history is full
+    - latest, range and downsampled queries
+    - invalid field history
+*/
+test(fieldSeriesCase)
+{
+  uint32_t times[4];
+  float values[4];
+  timeSeries history = {times, values, 4};
+  uint32_t outTimes[4];
+  float outValues[4];
+
+  assertEqual(TS_ERR_INVALID_FIELD_NUM, ThingSpeak.setFieldSeries(FIELD0, &history));
+  assertEqual(TS_ERR_INVALID_FIELD_NUM, ThingSpeak.setFieldSeries(FIELD9, &history));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setFieldSeries(FIELD1, &history));
+  ThingSpeak.setSeriesClock(testSeriesClock);
+
+  // samples at 0, 30, ... 150 seconds, the ring keeps the last four
+  for(int i = 0; i < 6; i++)
+  {
+    seriesClockSeconds = i * 30;
+    assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(FIELD1, i));
+  }
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(FIELD1, "foobar"));
+  assertEqual(4U, history.count);
+
+  assertEqual(2U, ThingSpeak.getSeriesLatest(FIELD1, outTimes, outValues, 2));
+  assertEqual(4.0, outValues[0]);
+  assertEqual(5.0, outValues[1]);
+  assertEqual(150UL, (unsigned long)outTimes[1]);
+
+  assertEqual(2U, ThingSpeak.getSeriesRange(FIELD1, 70, 125, outTimes, outValues, 4));
+  assertEqual(3.0, outValues[0]);
+  assertEqual(4.0, outValues[1]);
+
+  // one value per minute: (2+3)/2 at 60 and (4+5)/2 at 120
+  assertEqual(2U, ThingSpeak.getSeriesDownsampled(FIELD1, 0, 200, 60, outTimes, outValues, 4));
+  assertEqual(60UL, (unsigned long)outTimes[0]);
+  assertEqual(2.5, outValues[0]);
+  assertEqual(4.5, outValues[1]);
+
+  assertEqual(0U, ThingSpeak.getSeriesLatest(FIELD2, outTimes, outValues, 2));
+
+  ThingSpeak.setFieldSeries(FIELD1, NULL);
+  ThingSpeak.setSeriesClock(NULL);
+}
+
+/* This test case checks for the following:
+    - capture without storage and to a field out of range
+    - values are dropped when the capture buffer is full
+    - captured values are read oldest first
+    - captured values are set as fields and written
+*/
+test(captureFieldCase)
+{
+  capturedSample samples[3];
+  capturedSample sample;
+
+  ThingSpeak.setCaptureBuffer(NULL, 0);
+  assertEqual(TS_ERR_QUEUE_EMPTY, ThingSpeak.captureField(FIELD1, 1));
+
+  ThingSpeak.setCaptureBuffer(samples, 3);
+  assertEqual(TS_ERR_INVALID_FIELD_NUM, ThingSpeak.captureField(FIELD0, 1));
+  assertEqual(TS_ERR_INVALID_FIELD_NUM, ThingSpeak.captureField(FIELD9, 1));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.captureField(FIELD1, 100000L));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.captureField(FIELD2, (float)2.5));
+  assertEqual(TS_ERR_OUT_OF_RANGE, ThingSpeak.captureField(FIELD3, 3));
+  assertEqual(1UL, ThingSpeak.getCaptureDropped());
+
+  assertTrue(ThingSpeak.readCapturedSample(sample));
+  assertEqual(FIELD1, sample.field);
+  assertFalse(sample.isFloat);
+  assertEqual(100000L, sample.integer);
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.captureField(FIELD3, -47));
+  assertEqual(2U, ThingSpeak.stageCapturedFields());
+  assertFalse(ThingSpeak.readCapturedSample(sample));
+
+  // Always wait to ensure that rate limit isn't hit
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeFields(testChannelNumber, testChannelWriteAPIKey));
+
+  ThingSpeak.setCaptureBuffer(NULL, 0);
+}
+
+/* This test case checks for the following:
+    - schedule of a field out of range
+    - fields without a schedule are not written on their own
+    - a scheduled field is written when it is set for the first time
+    - no update before the interval has passed
+    - a field with onChange is written when its value changes, and not when it stays the same
+*/
+test(fieldScheduleCase)
+{
+  fieldSchedule periodic = { 60000 };
+  fieldSchedule changes = { 0, true };
+
+  assertEqual(TS_ERR_INVALID_FIELD_NUM, ThingSpeak.setFieldSchedule(FIELD0, &periodic));
+  assertEqual(TS_ERR_INVALID_FIELD_NUM, ThingSpeak.setFieldSchedule(FIELD9, &periodic));
+  ThingSpeak.setScheduleInterval(WRITE_DELAY_FOR_THINGSPEAK);
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(FIELD1, 1));
+  assertEqual(TS_ERR_QUEUE_EMPTY, ThingSpeak.serviceSchedule(testChannelNumber, testChannelWriteAPIKey));
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setFieldSchedule(FIELD1, &periodic));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setFieldSchedule(FIELD2, &changes));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(FIELD2, 10));
+
+  // Always wait to ensure that rate limit isn't hit
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.serviceSchedule(testChannelNumber, testChannelWriteAPIKey));
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(FIELD1, 2));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(FIELD2, 10));
+  assertEqual(TS_ERR_QUEUE_EMPTY, ThingSpeak.serviceSchedule(testChannelNumber, testChannelWriteAPIKey));
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_ERR_QUEUE_EMPTY, ThingSpeak.serviceSchedule(testChannelNumber, testChannelWriteAPIKey));
+
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(FIELD2, 11));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.serviceSchedule(testChannelNumber, testChannelWriteAPIKey));
+  assertEqual(0UL, ThingSpeak.getScheduleMisses());
+
+  ThingSpeak.setFieldSchedule(FIELD1, NULL);
+  ThingSpeak.setFieldSchedule(FIELD2, NULL);
+  ThingSpeak.setScheduleInterval(GATEWAY_INTERVAL_MS);
+}
+
 #if defined(ARDUINO_AVR_MEGA2560) || defined(ARDUINO_SAMD_MKR1000)  // Only the mega and mkr1000 has enough memory for all these tests
   /* This test case checks the following:
       - max/min values of float
@@ -0,0 +1,131 @@
+#line 2 "testTalkBack.ino"
+/*
+  testTalkBack unit test
+  
+  Unit Test for the TalkBack functions and kept-alive connections in the ThingSpeak Communication Library for Arduino
+  
+  This test use the ArduinoUnit 2.1.0 unit test framework.  Visit https://github.com/mmurdoch/arduinounit to learn more.
+  
+  ArduinoUnit does not support ESP8266 or ESP32 and therefor these tests will not compile for those platforms.
+  
+  ThingSpeak ( https://www.thingspeak.com ) is an analytic IoT platform service that allows you to aggregate, visualize, and 
+  analyze live data streams in the cloud. Visit https://www.thingspeak.com to sign up for a free account and create a channel.  
+  
+  Documentation for the ThingSpeak Communication Library for Arduino is in the README.md folder where the library was installed.
+  See https://www.mathworks.com/help/thingspeak/index.html for the full ThingSpeak documentation.
+  
+  For licensing information, see the accompanying license file.
+  
+  Copyright 2020-2025, The MathWorks, Inc.
+*/
+
+//#define USE_WIFI101_SHIELD
+//#define USE_ETHERNET_SHIELD
+
+#if !defined(USE_WIFI101_SHIELD) && !defined(USE_ETHERNET_SHIELD) && !defined(ARDUINO_SAMD_MKR1000) && !defined(ARDUINO_AVR_YUN)
+  #error "Uncomment the #define for either USE_WIFI101_SHIELD or USE_ETHERNET_SHIELD"
+#endif
+
+#include <ArduinoUnit.h>
+
+#if defined(ARDUINO_AVR_YUN)
+    #include "YunClient.h"
+    YunClient client;
+#else
+  #if defined(USE_WIFI101_SHIELD) || defined(ARDUINO_SAMD_MKR1000)
+    // Use WiFi  
+    #include <SPI.h>
+    #include <WiFi101.h>
+    char ssid[] = "<YOURNETWORK>";    //  your network SSID (name) 
+    char pass[] = "<YOURPASSWORD>";   // your network password   
+    int status = WL_IDLE_STATUS;
+    WiFiClient  client;
+  #elif defined(USE_ETHERNET_SHIELD)
+    // Use wired ethernet shield
+    #include <SPI.h>
+    #include <Ethernet.h>
+    byte mac[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED};
+    EthernetClient client;
+  #endif
+#endif
+
+#include <ThingSpeak.h> // always include thingspeak header file after other header files and custom macros
+
+unsigned long testChannelNumber = 1070863;
+const char * testChannelWriteAPIKey = "UI7FSU4O8ZJ5BM8O";
+const char * testChannelReadAPIKey = "I0QKRG8MU0HEFKYQ";
+
+unsigned long testTalkBackID = 1;
+const char * testTalkBackAPIKey = "AAAAAAAAAAAAAAAA"; // not a valid TalkBack API key
+
+#define WRITE_DELAY_FOR_THINGSPEAK 15000 // Data write limit for a free user (15 sec).
+
+#define COMMAND_QUEUE_SIZE 4
+
+talkBackCommand commands[COMMAND_QUEUE_SIZE];
+
+/* This test case checks for the following:
+    - poll without a command queue
+    - execute with an invalid TalkBack API key
+    - empty local command queue
+    - polling interval backs off after a failed poll
+*/
+test(talkBackCase)
+{
+  assertEqual(TS_ERR_QUEUE_EMPTY, ThingSpeak.pollTalkBack());
+
+  assertEqual(String(""), ThingSpeak.executeTalkBackCommand(testTalkBackID, testTalkBackAPIKey));
+  assertNotEqual(TS_OK_SUCCESS, ThingSpeak.getLastReadStatus());
+
+  ThingSpeak.setTalkBack(testTalkBackID, testTalkBackAPIKey, commands, COMMAND_QUEUE_SIZE);
+  ThingSpeak.setTalkBackPollInterval(1000, 4000);
+  assertEqual(1000UL, ThingSpeak.getTalkBackPollInterval());
+  assertNotEqual(TS_OK_SUCCESS, ThingSpeak.pollTalkBack());
+  assertEqual(0U, ThingSpeak.getTalkBackCount());
+  assertEqual(String(""), ThingSpeak.getTalkBackCommand());
+  assertEqual(2000UL, ThingSpeak.getTalkBackPollInterval());
+
+  // Not due yet
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.pollTalkBack());
+
+  ThingSpeak.setTalkBack(0, NULL, NULL, 0);
+}
+
+/* This test case checks for the following:
+    - write and read over a kept-alive connection
+*/
+test(keepAliveCase)
+{
+  ThingSpeak.setKeepAlive(true);
+
+  // Always wait to ensure that rate limit isn't hit
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeField(testChannelNumber, 1, 5, testChannelWriteAPIKey));
+  assertEqual(5, ThingSpeak.readIntField(testChannelNumber, 1, testChannelReadAPIKey));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.getLastReadStatus());
+  assertEqual(5, ThingSpeak.readIntField(testChannelNumber, 1, testChannelReadAPIKey));
+
+  ThingSpeak.setKeepAlive(false);
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  while(!Serial); // for the Arduino Leonardo/Micro only
+  Serial.println("Starting test...");
+  #ifdef ARDUINO_AVR_YUN
+    Bridge.begin();
+  #else   
+    #if defined(USE_WIFI101_SHIELD) || defined(ARDUINO_SAMD_MKR1000)
+      WiFi.begin(ssid, pass);
+    #else
+      Ethernet.begin(mac);
+    #endif
+  #endif
+  ThingSpeak.begin(client);
+}
+
+void loop()
+{
+  Test::run();
+}
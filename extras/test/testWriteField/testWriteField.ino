@@ -267,6 +267,47 @@ test(writeFieldFloatCase)
   }
 #endif // Mega and MKR1000 only tests
 
+/* This test case checks for the following:
+    - write on a connection opened by prepare()
+    - write after the prepared connection expired
+*/
+test(prepareCase)
+{
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.prepare());
+  delay(750); // sensor conversion time
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeField(testChannelNumber, FIELD1, 6, testChannelWriteAPIKey));
+
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.prepare(100));
+  delay(500);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeField(testChannelNumber, FIELD1, 7, testChannelWriteAPIKey));
+}
+
+requestHeader headers[1];
+
+/* This test case checks for the following:
+    - writes with a prepared request header
+    - a second API key reusing the only header slot
+*/
+test(requestHeaderCacheCase)
+{
+  ThingSpeak.setRequestHeaderCache(headers, 1);
+
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeField(testChannelNumber, FIELD1, 2, testChannelWriteAPIKey));
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.setField(FIELD1, 3));
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeFields(testChannelNumber, testChannelWriteAPIKey));
+
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_ERR_BADAPIKEY, ThingSpeak.writeField(testChannelNumber, FIELD1, 4, "AFAKEAPIKEYFAKEX"));
+  delay(WRITE_DELAY_FOR_THINGSPEAK);
+  assertEqual(TS_OK_SUCCESS, ThingSpeak.writeField(testChannelNumber, FIELD1, 5, testChannelWriteAPIKey));
+
+  ThingSpeak.setRequestHeaderCache(NULL, 0);
+}
+
 void setup()
 {
   Serial.begin(9600);
@@ -57,13 +57,56 @@
         #define TS_USER_AGENT "tslib-arduino/" TS_VER " (unknown)"
     #endif
 
+    // functions that may be called from an interrupt are kept in IRAM on ESP8266 and ESP32, where flash may not be readable during an interrupt
+    #if defined(ESP8266) || defined(ESP32)
+        #define TS_ISR_ATTR IRAM_ATTR
+    #else
+        #define TS_ISR_ATTR
+    #endif
+
     #define FIELDNUM_MIN 1
     #define FIELDNUM_MAX 8
     #define FIELDLENGTH_MAX 255  // Max length for a field in ThingSpeak is 255 bytes (UTF-8)
 
     #define TIMEOUT_MS_SERVERRESPONSE 5000  // Wait up to five seconds for server to respond
+    #define RESPONSEBUFFER_SIZE 32  // Bytes taken from the client with one read while parsing a response
+    #define REQUESTHEADER_MAX 240    // Room for one cached update request header, including its Content-Length value
+
+    #define READCACHE_SUFFIX_MAX 32  // Longest read URL suffix that can be cached, including terminator
+    #define READCACHE_VALUE_MAX 64   // Longest read response that can be cached, including terminator
+    #define FEEDVALUE_MAX 26         // Longest field value kept while parsing a feed into columns, including terminator, fits a timestamp with a zone offset
+    #define FEEDCOLUMNS_MAX 16       // Most columns of a CSV feed that are mapped
+
+    #define TS_FEED_FORMAT_JSON 0    // Read feeds as /feeds.json
+    #define TS_FEED_FORMAT_CSV  1    // Read feeds as /feeds.csv, about half the bytes of JSON
+
+    #define TS_LANE_URGENT 0         // Updates queued with queueUrgentFields()
+    #define TS_LANE_BULK   1         // Updates queued with queueFields()
+
+    #define TS_QUEUE_DROP_OLDEST 0   // A full update queue drops its oldest update
+    #define TS_QUEUE_DECIMATE    1   // A full update queue merges pairs of its oldest updates
+
+    #define TS_DECIMATE_MEAN 0       // Merged updates keep the mean of a field
+    #define TS_DECIMATE_MIN  1       // Merged updates keep the smallest value of a field
+    #define TS_DECIMATE_MAX  2       // Merged updates keep the largest value of a field
+
+    #define BULK_UPDATES_MAX 960     // Most updates ThingSpeak accepts in one bulk update
+    #define GATEWAY_INTERVAL_MS 15000 // Default time between writes to one channel in gateway mode, the update limit of a free account
+    #define SCHEDULE_TOLERANCE_MS 1000 // A scheduled field written later than this after its deadline counts as a miss
+    #define BACKFILL_LINE_MAX 160    // Longest line of a backfilled CSV log, including terminator, longer lines are skipped
+
+    #define KEEPALIVE_IDLE_MS 15000  // Reconnect instead of reusing a kept-alive connection idle for longer than this
+    #define PREPARE_WARM_MS 10000    // Default time a connection opened by prepare() waits for the next request
+    #define TALKBACK_COMMAND_MAX 64  // Longest TalkBack command kept in the command queue, including terminator
+
+    #define CHANNELINFO_VERSION 0x54430001UL // Stamp of a valid channelInfo record, changes with the record layout
+    #define CHANNELINFO_NAME_MAX 32  // Longest channel name kept in channelInfo, including terminator
+    #define CHANNELINFO_LABEL_MAX 24 // Longest field label kept in channelInfo, including terminator
+    #define CHANNELMIRROR_VERSION 0x544D0001UL // Stamp of a valid channelMirror record, changes with the record layout
 
     #define TS_OK_SUCCESS              200     // OK / Success
+    #define TS_OK_ACCEPTED             202     // OK / Bulk update accepted
+    #define TS_OK_NOT_MODIFIED         304     // OK / No new entry since the last readMultipleFields()
     #define TS_ERR_BADAPIKEY           400     // Incorrect API key (or invalid ThingSpeak server address)
     #define TS_ERR_BADURL              404     // Incorrect API key (or invalid ThingSpeak server address)
     #define TS_ERR_OUT_OF_RANGE        -101    // Value is out of range or string is too long (> 255 bytes)
@@ -74,6 +117,7 @@
     #define TS_ERR_BAD_RESPONSE        -303    // Unable to parse response
     #define TS_ERR_TIMEOUT             -304    // Timeout waiting for server to respond
     #define TS_ERR_NOT_INSERTED        -401    // Point was not inserted (most probable cause is the rate limit of once every 15 seconds)
+    #define TS_ERR_QUEUE_EMPTY         -501    // queueFields() was not called before writeQueuedFields(), or no queue was set
 
     
     // variables to store the values from the readMultipleFields functionality
@@ -89,6 +133,152 @@
         }feed;
     #endif
 
+    // columnar storage for readFeedColumns(), all arrays are provided by the user sketch and hold at least capacity elements
+    typedef struct feedColumnsRecord
+    {
+        uint32_t * createdAt;   // created-at timestamp in seconds since 1970-01-01 UTC, or NULL if not needed
+        uint32_t * entryID;     // entry ID, or NULL if not needed
+        float * field[8];       // field values with NAN for missing or non-numeric values, or NULL for fields that are not needed
+        unsigned int capacity;
+        unsigned int count;     // number of records stored by the last read
+    }feedColumns;
+
+    // history of one field for the on-device time-series store, the arrays are provided by the user sketch and hold capacity elements
+    typedef struct timeSeriesRecord
+    {
+        uint32_t * time;        // timestamp of each sample in seconds, see setSeriesClock()
+        float * value;
+        unsigned int capacity;
+        unsigned int start;     // index of the oldest sample
+        unsigned int count;
+    }timeSeries;
+
+    // values set with setField(), setStatus() and the like for the next update, the library keeps two so that one can be set while the other is sent
+    typedef struct writeStagingRecord
+    {
+        String field[8];
+        float latitude;         // NAN when not set
+        float longitude;
+        float elevation;
+        String status;
+        String createdAt;
+    }writeStaging;
+
+    // one value taken by captureField(), stored as it was given, storage is provided by the user sketch through setCaptureBuffer()
+    typedef struct capturedSampleRecord
+    {
+        uint32_t time;          // millis() when the value was captured
+        union
+        {
+            long integer;
+            float number;
+        };
+        uint8_t field;
+        bool isFloat;           // number holds the value, otherwise integer
+    }capturedSample;
+
+    // when a field has to be written by serviceSchedule(), the sketch sets periodMS and onChange, the rest is kept by the library
+    typedef struct fieldScheduleRecord
+    {
+        unsigned long periodMS; // longest time between two writes of the field, 0 for none
+        bool onChange;          // write the field as soon as it is set to a different value
+        bool written;           // the field was written since setFieldSchedule()
+        bool pending;           // the field is due and waits for a write
+        uint32_t dueAt;         // millis() of the deadline of the pending write
+        uint32_t lastWriteAt;   // millis() of the last write of the field
+        unsigned long lastValueHash; // hash of the last written value, for onChange
+        unsigned long misses;   // writes later than SCHEDULE_TOLERANCE_MS after the deadline
+    }fieldSchedule;
+
+    // one update waiting in the queue for writeQueuedFields(), storage is provided by the user sketch through setUpdateQueue()
+    typedef struct queuedUpdateRecord
+    {
+        uint32_t time;          // millis() when the update was queued
+        float field[8];         // NAN for fields that were not set
+        uint16_t samples;       // updates merged into this one, 1 unless the queue was decimated
+    }queuedUpdate;
+
+    // one channel written by serviceGateway(), the sketch sets channelNumber, writeAPIKey, updates and capacity, the rest is kept by the library
+    typedef struct gatewayChannelRecord
+    {
+        unsigned long channelNumber;
+        const char * writeAPIKey;
+        queuedUpdate * updates; // update queue of the channel, provided by the user sketch
+        unsigned int capacity;
+        unsigned int start;     // index of the oldest queued update
+        unsigned int count;
+        unsigned long dropped;  // updates dropped because the queue was full
+        uint32_t lastWriteAt;   // millis() of the last write attempt
+    }gatewayChannel;
+
+    // a CSV log written to a channel by serviceBackfill(), the sketch sets channelNumber, writeAPIKey, updates, capacity and offset, the rest is kept by the library
+    typedef struct backfillJobRecord
+    {
+        unsigned long channelNumber;
+        const char * writeAPIKey;
+        queuedUpdate * updates; // rows read from the log and not yet written, time is the created-at timestamp in seconds since 1970-01-01 UTC
+        unsigned int capacity;  // rows sent in one bulk update, at most BULK_UPDATES_MAX are used
+        uint32_t offset;        // byte offset in the log of the first row not yet written, the checkpoint to save
+        uint32_t readOffset;    // byte offset in the log of the next byte to read
+        unsigned int count;
+        unsigned long rowsWritten;
+        unsigned long rowsSkipped; // lines that are not a row, like a header line
+        unsigned long interval;
+        uint32_t startedAt;     // millis() when beginBackfill() was called
+        uint32_t lastWriteAt;   // millis() of the last write attempt
+        bool ended;             // the whole log was read
+    }backfillJob;
+
+    // one command in the TalkBack command queue, storage is provided by the user sketch through setTalkBack()
+    typedef struct talkBackCommandRecord
+    {
+        char command[TALKBACK_COMMAND_MAX];
+    }talkBackCommand;
+
+    // channel description read by readChannelInfo(), plain data so that a sketch can keep it in EEPROM or flash
+    typedef struct channelInfoRecord
+    {
+        uint32_t version;       // CHANNELINFO_VERSION when the record holds valid metadata
+        uint32_t channelNumber;
+        uint32_t updatedAt;     // last change of the channel settings in seconds since 1970-01-01 UTC
+        uint32_t lastEntryID;   // entry ID of the latest update when the record was read
+        uint8_t activeFields;   // bit n-1 is set when field n is enabled
+        char name[CHANNELINFO_NAME_MAX];
+        char fieldLabel[8][CHANNELINFO_LABEL_MAX];
+    }channelInfo;
+
+    // sync state of a local copy of a channel kept by syncChannelMirror(), plain data so that a sketch can keep it in EEPROM or flash next to the copy
+    typedef struct channelMirrorRecord
+    {
+        uint32_t version;       // CHANNELMIRROR_VERSION once the mirror was started
+        uint32_t channelNumber;
+        uint32_t lastEntryID;   // entry ID of the newest entry in the copy, the high-water mark
+        uint32_t lastCreatedAt; // its created-at timestamp in seconds since 1970-01-01 UTC
+        uint32_t syncedTo;      // start of the next time window to read, all older entries are in the copy
+        uint32_t span;          // length of the next time window in seconds, 0 for a window without end
+        uint32_t channelLastEntryID; // newest entry ID of the channel at the last sync
+    }channelMirror;
+
+    // header of an update request for one write API key, storage is provided by the user sketch through setRequestHeaderCache()
+    typedef struct requestHeaderRecord
+    {
+        uint8_t keyOffset;      // position of the API key in text, 0 while the slot is unused
+        uint8_t keyLength;
+        uint8_t length;         // length of the header up to and including "Content-Length: "
+        char text[REQUESTHEADER_MAX];
+    }requestHeader;
+
+    // one slot of the optional read cache, storage is provided by the user sketch through setReadCache()
+    typedef struct readCacheRecord
+    {
+        unsigned long channelNumber;
+        unsigned long keyHash;
+        unsigned long storedAt;
+        bool valid;
+        char suffixURL[READCACHE_SUFFIX_MAX];
+        char value[READCACHE_VALUE_MAX];
+    }readCacheEntry;
+
 
     // Enables an Arduino, ESP8266, ESP32 or other compatible hardware to write or read data to or from ThingSpeak, an open data platform for the Internet of Things with MATLAB analytics and visualization.
     class ThingSpeakClass
@@ -96,9 +286,86 @@
       public:
         ThingSpeakClass()
         {
-            resetWriteFields();
+            #if defined(ARDUINO_ARCH_ESP32)
+                this->stagingLock = xSemaphoreCreateMutex();
+            #endif
+            clearStagedWrite(this->stagedWrites[0]);
+            clearStagedWrite(this->stagedWrites[1]);
             this->lastReadStatus = TS_OK_SUCCESS;
+            this->readCache = NULL;
+            this->readCacheSize = 0;
+            this->readCacheTTL = 0;
+            this->readCacheHits = 0;
+            this->readCacheMisses = 0;
+            for(size_t iField = 0; iField < FIELDNUM_MAX; iField++)
+            {
+                this->fieldSeries[iField] = NULL;
+                this->fieldSchedules[iField] = NULL;
+                this->fieldDecimation[iField] = TS_DECIMATE_MEAN;
+            }
+            this->scheduleInterval = GATEWAY_INTERVAL_MS;
+            this->scheduleLastWrite = 0;
+            this->scheduleWritten = false;
+            this->seriesClock = NULL;
+            this->feedFormat = TS_FEED_FORMAT_JSON;
+            this->updateQueue = NULL;
+            this->updateQueueSize = 0;
+            this->updateQueueStart = 0;
+            this->updateQueueCount = 0;
+            this->updateQueueDropped = 0;
+            this->queueOverflow = TS_QUEUE_DROP_OLDEST;
+            this->updateQueueInterval = GATEWAY_INTERVAL_MS;
+            this->updateQueueLastWrite = 0;
+            this->updateQueueWritten = false;
+            clearStagedWrite(this->urgentWrite);
+            this->urgentPending = false;
+            this->urgentQueuedAt = 0;
+            for(size_t iLane = 0; iLane < 2; iLane++)
+            {
+                this->laneLatency[iLane] = 0;
+                this->laneMaxLatency[iLane] = 0;
+            }
+            this->mirrorAppended = 0;
+            this->captureBuffer = NULL;
+            this->captureSize = 0;
+            this->captureHead = 0;
+            this->captureTail = 0;
+            this->captureDropped = 0;
+            this->gatewayChannels = NULL;
+            this->numGatewayChannels = 0;
+            this->gatewayInterval = GATEWAY_INTERVAL_MS;
+            this->gatewayNext = 0;
+            this->gatewayLast = 0;
+            this->keepAlive = false;
+            this->connectionReused = false;
+            this->responseStarted = false;
+            this->lastActivity = 0;
+            this->prepared = false;
+            this->preparedAt = 0;
+            this->prepareWarmMS = PREPARE_WARM_MS;
+            this->talkBackID = 0;
+            this->talkBackAPIKey = NULL;
+            this->talkBackQueue = NULL;
+            this->talkBackQueueSize = 0;
+            this->talkBackQueueStart = 0;
+            this->talkBackQueueCount = 0;
+            this->talkBackMinIntervalMS = 1000;
+            this->talkBackMaxIntervalMS = 60000;
+            this->talkBackIntervalMS = 1000;
+            this->talkBackLastPoll = 0;
+            this->talkBackPolled = false;
+            this->channelInfoRecord = NULL;
+            this->requestHeaders = NULL;
+            this->requestHeaderCount = 0;
+            this->requestHeaderNext = 0;
         }
+        
+        #if defined(ARDUINO_ARCH_ESP32)
+            ~ThingSpeakClass()
+            {
+                vSemaphoreDelete(this->stagingLock);
+            }
+        #endif
 
 
         /*
@@ -123,23 +390,200 @@
                 Serial.println("ts::tsBegin");
             #endif
             
-            this->setClient(&client);
-            
-            this->setPort(THINGSPEAK_PORT_NUMBER);
+            unsigned int port = THINGSPEAK_PORT_NUMBER;
             #if defined(TS_ENABLE_SSL)
-                #if defined(WIFISSLCLIENT_H) || defined(wificlientbearssl_h) || defined(WiFiClientSecure_h)
-                    this->setPort(THINGSPEAK_HTTPS_PORT_NUMBER);
+                #if defined(WIFISSLCLIENT_H) || defined(wificlientbearssl_h) || defined(WiFiClientSecure_h) || defined(ThingSpeakESP32Client_h)
+                    port = THINGSPEAK_HTTPS_PORT_NUMBER;
                 #else
                     Serial.println("WARNING: This library doesn't support SSL connection to ThingSpeak. Default HTTP Connection used.");
                 #endif
             #endif
-    
-            resetWriteFields();
-            this->lastReadStatus = TS_OK_SUCCESS;
+            
+            setEndpoint(client, THINGSPEAK_URL, port, NULL, NULL);
+            return true;
+        }
+        
+        
+        /*
+        Function: begin
+        
+        Summary:
+        Initializes the ThingSpeak library and network settings using a custom server, such as a relay on the local network or a self-hosted server.
+        
+        Parameters:
+        client - EthernetClient, YunClient, TCPClient, or WiFiClient for HTTP connection and WiFiSSLClient, WiFiClientSecure for HTTPS connection created earlier in the sketch.
+        hostName - Host name of the server, like "relay.local" or "192.168.1.10"
+        port - Port of the server
+        pathPrefix - Path put in front of the path of every request, like "/thingspeak", or NULL for none
+        hostHeader - Value of the Host header of the requests, or NULL to send hostName
+        
+        Returns:
+        Always returns true
+        
+        Notes:
+        The strings must stay valid while the library is used.  This does not validate the information passed in, or generate any calls to the server.
+        */
+        bool begin(Client & client, const char * hostName, unsigned int port, const char * pathPrefix, const char * hostHeader)
+        {
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::tsBegin (hostName: "); Serial.print(hostName); Serial.print(" port: "); Serial.print(port); Serial.println(")");
+            #endif
+            
+            setEndpoint(client, hostName, port, pathPrefix, hostHeader);
+            return true;
+        }
+        
+        
+        /*
+        Function: begin
+        
+        Summary:
+        Initializes the ThingSpeak library and network settings using a custom server, such as a relay on the local network or a self-hosted server.
+        
+        Parameters:
+        client - EthernetClient, YunClient, TCPClient, or WiFiClient for HTTP connection and WiFiSSLClient, WiFiClientSecure for HTTPS connection created earlier in the sketch.
+        hostName - Host name of the server, like "relay.local" or "192.168.1.10"
+        port - Port of the server
+        
+        Returns:
+        Always returns true
+        
+        Notes:
+        hostName must stay valid while the library is used.  It is also sent as the Host header.
+        */
+        bool begin(Client & client, const char * hostName, unsigned int port)
+        {
+            return begin(client, hostName, port, NULL, NULL);
+        }
+        
+        
+        /*
+        Function: begin
+        
+        Summary:
+        Initializes the ThingSpeak library and network settings using a custom server that is addressed by its IP address.
+        
+        Parameters:
+        client - EthernetClient, YunClient, TCPClient, or WiFiClient for HTTP connection and WiFiSSLClient, WiFiClientSecure for HTTPS connection created earlier in the sketch.
+        ip - IP address of the server
+        port - Port of the server
+        pathPrefix - Path put in front of the path of every request, like "/thingspeak", or NULL for none
+        hostHeader - Value of the Host header of the requests, or NULL to send api.thingspeak.com
+        
+        Returns:
+        Always returns true
+        
+        Notes:
+        The strings must stay valid while the library is used.  This does not validate the information passed in, or generate any calls to the server.
+        */
+        bool begin(Client & client, IPAddress ip, unsigned int port, const char * pathPrefix, const char * hostHeader)
+        {
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::tsBegin (ip: "); Serial.print(ip); Serial.print(" port: "); Serial.print(port); Serial.println(")");
+            #endif
+            
+            setEndpoint(client, NULL, port, pathPrefix, hostHeader);
+            this->hostIP = ip;
             return true;
         }
         
         
+        /*
+        Function: begin
+        
+        Summary:
+        Initializes the ThingSpeak library and network settings using a custom server that is addressed by its IP address.
+        
+        Parameters:
+        client - EthernetClient, YunClient, TCPClient, or WiFiClient for HTTP connection and WiFiSSLClient, WiFiClientSecure for HTTPS connection created earlier in the sketch.
+        ip - IP address of the server
+        port - Port of the server
+        
+        Returns:
+        Always returns true
+        
+        Notes:
+        The requests are sent with the Host header of api.thingspeak.com.
+        */
+        bool begin(Client & client, IPAddress ip, unsigned int port)
+        {
+            return begin(client, ip, port, NULL, NULL);
+        }
+        
+        
+        /*
+        Function: setKeepAlive
+        
+        Summary:
+        Keep the connection to ThingSpeak open between requests.
+        
+        Parameters:
+        keepAlive - true to keep the connection open after a successful request, false (default) to close it after every request.
+        
+        Notes:
+        Reusing a connection saves the TCP (and TLS) handshake of the next request.  A connection that was idle for more than 15 seconds is not reused, since the server is likely to have closed it.  When a reused connection turns out to be closed and no response came back, the request is sent once more on a new connection.
+        Calling setKeepAlive(false) closes a kept-alive connection.
+        */
+        void setKeepAlive(bool keepAlive)
+        {
+            this->keepAlive = keepAlive;
+            if(!keepAlive && NULL != this->client && this->client->connected())
+            {
+                this->client->stop();
+            }
+        }
+
+
+        /*
+        Function: prepare
+        
+        Summary:
+        Connect to ThingSpeak in advance, for example while a sensor is still measuring, so that the next write or read does not wait for the connection.
+        
+        Parameters:
+        warmMS - Time in milliseconds the connection waits for the next request.  If no request comes in time, the next request connects again.
+        
+        Returns:
+        HTTP status code of 200 if successful.
+        Code of -301 if the connection failed
+        
+        Notes:
+        The connection, including the TLS handshake of a secure connection, is used by the next request of any kind, and closed after it unless setKeepAlive(true) was called.
+        If the server closed the connection meanwhile and no response comes back, the request is sent once more on a new connection.
+        */
+        int prepare(unsigned long warmMS)
+        {
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::prepare (warmMS: "); Serial.print(warmMS); Serial.println(")");
+            #endif
+            if(!connectThingSpeak())
+            {
+                return TS_ERR_CONNECT_FAILED;
+            }
+            this->prepared = true;
+            this->preparedAt = millis();
+            this->prepareWarmMS = warmMS;
+            
+            return TS_OK_SUCCESS;
+        }
+
+
+        /*
+        Function: prepare
+        
+        Summary:
+        Connect to ThingSpeak in advance, and keep the connection for the next request for up to 10 seconds.
+        
+        Returns:
+        HTTP status code of 200 if successful.
+        Code of -301 if the connection failed
+        */
+        int prepare()
+        {
+            return prepare(PREPARE_WARM_MS);
+        }
+
+
         /*
         Function: writeField
         
@@ -250,6 +694,8 @@
             #ifdef PRINT_DEBUG_MESSAGES
                 Serial.print("ts::writeField (channelNumber: "); Serial.print(channelNumber); Serial.print(" writeAPIKey: "); Serial.print(writeAPIKey); Serial.print(" field: "); Serial.print(field); Serial.print(" value: \""); Serial.print(value); Serial.println("\")");
             #endif
+            recordSeriesSample(field, value);
+            
             String postMessage = String("field");
             postMessage.concat(field);
             postMessage.concat("=");
@@ -259,6 +705,36 @@
         }
 
              
+        /*
+        Function: setRequestHeaderCache
+        
+        Summary:
+        Set the storage for prepared update request headers, one for each write API key the sketch uses.
+        
+        Parameters:
+        headers - Array of requestHeader created earlier in the sketch, or NULL to build the header for every update.
+        numHeaders - Number of elements in headers, usually the number of channels the sketch writes to.
+        
+        Returns:
+        Always returns true
+        
+        Notes:
+        writeFields() and writeRaw() build the request line and header lines of an update the first time an API key is used, and send them with one write to the client for every later update with the same key.
+        When there are more API keys than slots, the slots are reused in turn.
+        */
+        bool setRequestHeaderCache(requestHeader * headers, unsigned int numHeaders)
+        {
+            this->requestHeaders = headers;
+            this->requestHeaderCount = (NULL == headers) ? 0 : numHeaders;
+            this->requestHeaderNext = 0;
+            for(unsigned int i = 0; i < this->requestHeaderCount; i++)
+            {
+                this->requestHeaders[i].keyOffset = 0;
+            }
+            return true;
+        }
+
+
         /*
         Function: setField
         
@@ -341,6 +817,7 @@
         Returns:
         Code of 200 if successful.
         Code of -101 if value is out of range or string is too long (> 255 bytes)
+        Code of -201 if the field number is invalid, or the field is not enabled in the channel info set with setChannelInfo()
         */
         int setField(unsigned int field, String value)
         {
@@ -348,9 +825,13 @@
                 Serial.print("ts::setField   (field: "); Serial.print(field); Serial.print(" value: \""); Serial.print(value); Serial.println("\")");
             #endif
             if(field < FIELDNUM_MIN || field > FIELDNUM_MAX) return TS_ERR_INVALID_FIELD_NUM;
+            if(!isFieldActive(field)) return TS_ERR_INVALID_FIELD_NUM;
             // Max # bytes for ThingSpeak field is 255 (UTF-8)
             if(value.length() > FIELDLENGTH_MAX) return TS_ERR_OUT_OF_RANGE;
-            this->nextWriteField[field - 1] = value;
+            lockStaging();
+            nextWrite().field[field - 1] = value;
+            unlockStaging();
+            recordSeriesSample(field, value);
             
             return TS_OK_SUCCESS;
         }
@@ -376,7 +857,9 @@
             #ifdef PRINT_DEBUG_MESSAGES
                 Serial.print("ts::setLatitude(latitude: "); Serial.print(latitude,3); Serial.println("\")");
             #endif
-            this->nextWriteLatitude = latitude;
+            lockStaging();
+            nextWrite().latitude = latitude;
+            unlockStaging();
             
             return TS_OK_SUCCESS;
         }
@@ -402,7 +885,9 @@
             #ifdef PRINT_DEBUG_MESSAGES
                 Serial.print("ts::setLongitude(longitude: "); Serial.print(longitude,3); Serial.println("\")");
             #endif
-            this->nextWriteLongitude = longitude;
+            lockStaging();
+            nextWrite().longitude = longitude;
+            unlockStaging();
             
             return TS_OK_SUCCESS;
         }
@@ -429,7 +914,9 @@
             #ifdef PRINT_DEBUG_MESSAGES
                 Serial.print("ts::setElevation(elevation: "); Serial.print(elevation,3); Serial.println("\")");
             #endif
-            this->nextWriteElevation = elevation;
+            lockStaging();
+            nextWrite().elevation = elevation;
+            unlockStaging();
             
             return TS_OK_SUCCESS;
         }
@@ -459,7 +946,9 @@
             #endif
             // Max # bytes for ThingSpeak field is 255 (UTF-8)
             if(status.length() > FIELDLENGTH_MAX) return TS_ERR_OUT_OF_RANGE;
-            this->nextWriteStatus = status;
+            lockStaging();
+            nextWrite().status = status;
+            unlockStaging();
             
             return TS_OK_SUCCESS;
         }
@@ -492,1124 +981,4605 @@
             // we'll need to reply on the api to tell us if there is a problem
             // Max # bytes for ThingSpeak field is 255 (UTF-8)
             if(createdAt.length() > FIELDLENGTH_MAX) return TS_ERR_OUT_OF_RANGE;
-            this->nextWriteCreatedAt = createdAt;
+            lockStaging();
+            nextWrite().createdAt = createdAt;
+            unlockStaging();
             
             return TS_OK_SUCCESS;
         }
-        
+
      
         /*
-        Function: writeFields
+        Function: setCaptureBuffer
         
         Summary:
-        Write a multi-field update.
+        Set the storage for values taken by captureField(), for example from an interrupt, until stageCapturedFields() sets them as fields.
         
         Parameters:
-        channelNumber - Channel number
-        writeAPIKey - Write API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        samples - Array of capturedSample created earlier in the sketch, or NULL to stop capturing.
+        numSamples - Number of elements in samples.  One element is kept free, so at most numSamples - 1 values wait at a time.
+        
+        Returns:
+        Always returns true
+        
+        Notes:
+        Call it while no interrupt captures values, for example before attachInterrupt().
+        */
+        bool setCaptureBuffer(capturedSample * samples, unsigned int numSamples)
+        {
+            this->captureSize = 0;
+            this->captureBuffer = samples;
+            this->captureHead = 0;
+            this->captureTail = 0;
+            this->captureDropped = 0;
+            this->captureSize = (NULL == samples || numSamples < 2) ? 0 : numSamples;
+            return true;
+        }
+        
+        
+        /*
+        Function: captureField
+        
+        Summary:
+        Take the value of a field in an interrupt or another time-critical place, without formatting it or allocating memory.
+        
+        Parameters:
+        field - Field number (1-8) within the channel to set.
+        value - Long value to capture.
         
         Returns:
         200 - successful.
-        404 - Incorrect API key (or invalid ThingSpeak server address)
-        -101 - Value is out of range or string is too long (> 255 characters)
+        -101 - The capture buffer is full, the value was dropped
         -201 - Invalid field number specified
-        -210 - setField() was not called before writeFields()
-        -301 - Failed to connect to ThingSpeak
-        -302 - Unexpected failure during write to ThingSpeak
-        -303 - Unable to parse response
-        -304 - Timeout waiting for server to respond
-        -401 - Point was not inserted (most probable cause is the rate limit of once every 15 seconds)
+        -501 - setCaptureBuffer() was not called before captureField()
         
         Notes:
-        Call setField(), setLatitude(), setLongitude(), setElevation() and/or setStatus() and then call writeFields()
+        The value and the time are stored as they are.  They are formatted when stageCapturedFields() is called from loop().
+        Safe to call from one interrupt (or task) at a time while loop() calls stageCapturedFields().
         */
-        int writeFields(unsigned long channelNumber, const char * writeAPIKey)
+        TS_ISR_ATTR int captureField(unsigned int field, long value)
         {
-            if(!connectThingSpeak()){
-                // Failed to connect to ThingSpeak
-                return TS_ERR_CONNECT_FAILED;
-            }
-            
-            // Get the content length of the payload
-            int contentLen = getWriteFieldsContentLength();
-            
-            if(contentLen == 0){
-                // setField was not called before writeFields
-                return TS_ERR_SETFIELD_NOT_CALLED;
+            capturedSample * sample = nextCaptureSlot(field);
+            if(NULL == sample)
+            {
+                return (field < FIELDNUM_MIN || field > FIELDNUM_MAX) ? TS_ERR_INVALID_FIELD_NUM : ((0 == this->captureSize) ? TS_ERR_QUEUE_EMPTY : TS_ERR_OUT_OF_RANGE);
             }
-            
-            #ifdef PRINT_DEBUG_MESSAGES
-                Serial.print("ts::writeFields   (channelNumber: "); Serial.print(channelNumber); Serial.print(" writeAPIKey: "); Serial.println(writeAPIKey);
-            #endif
-            
-            // Post data to thingspeak
-            if(!this->client->print("POST /update HTTP/1.1\r\n")) return abortWriteRaw();
-            if(!writeHTTPHeader(writeAPIKey)) return abortWriteRaw();
-            if(!this->client->print("Content-Type: application/x-www-form-urlencoded\r\n")) return abortWriteRaw();
-            if(!this->client->print("Content-Length: ")) return abortWriteRaw();
-            if(!this->client->print(contentLen)) return abortWriteRaw();
-            if(!this->client->print("\r\n\r\n")) return abortWriteRaw();
-                
-            bool fFirstItem = true;
-            for(size_t iField = 0; iField < FIELDNUM_MAX; iField++){
-                if(this->nextWriteField[iField].length() > 0){
-                    if(!fFirstItem){
-                        if(!this->client->print("&")) return abortWriteRaw();
-                    }
-                    if(!this->client->print("field")) return abortWriteRaw();
-                    if(!this->client->print(iField + 1)) return abortWriteRaw();
-                    if(!this->client->print("=")) return abortWriteRaw();
-                    if(!this->client->print(this->nextWriteField[iField])) return abortWriteRaw();
-                    fFirstItem = false;
-                }
-            }
-            
-            if(!isnan(this->nextWriteLatitude)){
-                if(!fFirstItem){
-                    if(!this->client->print("&")) return abortWriteRaw();
-                }
-                if(!this->client->print("lat=")) return abortWriteRaw();
-                if(!this->client->print(this->nextWriteLatitude)) return abortWriteRaw();
-                fFirstItem = false;
-            }
-
-            if(!isnan(this->nextWriteLongitude)){
-                if(!fFirstItem){
-                    if(!this->client->print("&")) return abortWriteRaw();
-                }
-                if(!this->client->print("long=")) return abortWriteRaw();
-                if(!this->client->print(this->nextWriteLongitude)) return abortWriteRaw();
-                fFirstItem = false;
-            }
-
-            if(!isnan(this->nextWriteElevation)){
-                if(!fFirstItem){
-                    if(!this->client->print("&")) return abortWriteRaw();
-                }
-                if(!this->client->print("elevation=")) return abortWriteRaw();
-                if(!this->client->print(this->nextWriteElevation)) return abortWriteRaw();
-                fFirstItem = false;
-            }
-            
-            if(this->nextWriteStatus.length() > 0){
-                if(!fFirstItem){
-                    if(!this->client->print("&")) return abortWriteRaw();
-                }
-                if(!this->client->print("status=")) return abortWriteRaw();
-                if(!this->client->print(this->nextWriteStatus)) return abortWriteRaw();
-                fFirstItem = false;
-            }
-            
-            if(this->nextWriteCreatedAt.length() > 0){
-                if(!fFirstItem){
-                    if(!this->client->print("&")) return abortWriteRaw();
-                }
-                if(!this->client->print("created_at=")) return abortWriteRaw();
-                if(!this->client->print(this->nextWriteCreatedAt)) return abortWriteRaw();
-                fFirstItem = false;
-            }
-
-            if(!this->client->print("&headers=false")) return abortWriteRaw();
-            
-            resetWriteFields();
-            
-            return finishWrite();
+            sample->integer = value;
+            sample->isFloat = false;
+            publishCapturedSample();
+            return TS_OK_SUCCESS;
         }
-
-         
+        
+        
         /*
-        Function: writeRaw
+        Function: captureField
         
         Summary:
-        Write a raw POST to a ThingSpeak channel
+        Take the value of a field in an interrupt or another time-critical place, without formatting it or allocating memory.
         
         Parameters:
-        channelNumber - Channel number
-        postMessage - Raw URL to write to ThingSpeak as a string.  See the documentation at https://thingspeak.com/docs/channels#update_feed.
-        writeAPIKey - Write API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        field - Field number (1-8) within the channel to set.
+        value - Integer value to capture.
         
         Returns:
-        200 - successful.
-        404 - Incorrect API key (or invalid ThingSpeak server address)
-        -101 - Value is out of range or string is too long (> 255 characters)
-        -201 - Invalid field number specified
-        -210 - setField() was not called before writeFields()
-        -301 - Failed to connect to ThingSpeak
-        -302 - Unexpected failure during write to ThingSpeak
-        -303 - Unable to parse response
-        -304 - Timeout waiting for server to respond
-        -401 - Point was not inserted (most probable cause is the rate limit of once every 15 seconds)
-        
-        Notes:
-        This is low level functionality that will not be required by most users.
+        See the long overload
         */
-        int writeRaw(unsigned long channelNumber, String postMessage, const char * writeAPIKey)
+        TS_ISR_ATTR int captureField(unsigned int field, int value)
         {
-            #ifdef PRINT_DEBUG_MESSAGES
-                Serial.print("ts::writeRaw   (channelNumber: "); Serial.print(channelNumber); Serial.print(" writeAPIKey: "); Serial.println(writeAPIKey);
-            #endif
-
-            if(!connectThingSpeak())
-            {
-                // Failed to connect to ThingSpeak
-                return TS_ERR_CONNECT_FAILED;
-            }
-
-            postMessage.concat("&headers=false");
-            
-            #ifdef PRINT_DEBUG_MESSAGES
-                Serial.print("               POST \"");Serial.print(postMessage);Serial.println("\"");
-            #endif
-
-
-            // Post data to thingspeak
-            if(!this->client->print("POST /update HTTP/1.1\r\n")) return abortWriteRaw();
-            if(!writeHTTPHeader(writeAPIKey)) return abortWriteRaw();
-            if(!this->client->print("Content-Type: application/x-www-form-urlencoded\r\n")) return abortWriteRaw();
-            if(!this->client->print("Content-Length: ")) return abortWriteRaw();
-            if(!this->client->print(postMessage.length())) return abortWriteRaw();
-            if(!this->client->print("\r\n\r\n")) return abortWriteRaw();
-            if(!this->client->print(postMessage)) return abortWriteRaw();
-            
-            resetWriteFields();
-            
-            return finishWrite();
+            return captureField(field, (long)value);
         }
         
-         
+        
         /*
-        Function: readStringField
+        Function: captureField
         
         Summary:
-        Read the latest string from a private ThingSpeak channel
+        Take the value of a field in an interrupt or another time-critical place, without formatting it or allocating memory.
         
         Parameters:
-        channelNumber - Channel number
-        field - Field number (1-8) within the channel to read from.
-        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        field - Field number (1-8) within the channel to set.
+        value - Float value to capture.
         
         Returns:
-        Value read (UTF8 string), or empty string if there is an error.  Use getLastReadStatus() to get more specific information.
+        See the long overload
         */
-        String readStringField(unsigned long channelNumber, unsigned int field, const char * readAPIKey)
+        TS_ISR_ATTR int captureField(unsigned int field, float value)
         {
-            if(field < FIELDNUM_MIN || field > FIELDNUM_MAX)
+            capturedSample * sample = nextCaptureSlot(field);
+            if(NULL == sample)
             {
-                this->lastReadStatus = TS_ERR_INVALID_FIELD_NUM;
-                return("");
+                return (field < FIELDNUM_MIN || field > FIELDNUM_MAX) ? TS_ERR_INVALID_FIELD_NUM : ((0 == this->captureSize) ? TS_ERR_QUEUE_EMPTY : TS_ERR_OUT_OF_RANGE);
             }
-            #ifdef PRINT_DEBUG_MESSAGES
-                Serial.print("ts::readStringField(channelNumber: "); Serial.print(channelNumber);
-                if(NULL != readAPIKey)
-                {
-                    Serial.print(" readAPIKey: "); Serial.print(readAPIKey);
-                }
-                Serial.print(" field: "); Serial.print(field); Serial.println(")");
-            #endif
-            String suffixURL = String("/fields/");
-            suffixURL.concat(field);
-            suffixURL.concat("/last");
-            
-            return readRaw(channelNumber, suffixURL, readAPIKey);
+            sample->number = value;
+            sample->isFloat = true;
+            publishCapturedSample();
+            return TS_OK_SUCCESS;
         }
-
-
+        
+        
         /*
-        Function: readStringField
+        Function: readCapturedSample
         
         Summary:
-        Read the latest string from a public ThingSpeak channel
+        Take the oldest value waiting in the capture buffer, to handle it in the sketch instead of with stageCapturedFields().
         
         Parameters:
-        channelNumber - Channel number
-        field - Field number (1-8) within the channel to read from.
+        sample - capturedSample that the value is copied to
         
         Returns:
-        Value read (UTF8 string), or empty string if there is an error.  Use getLastReadStatus() to get more specific information.
+        true if a value was taken, false if none is waiting
         */
-        String readStringField(unsigned long channelNumber, unsigned int field)
+        bool readCapturedSample(capturedSample & sample)
         {
-            return readStringField(channelNumber, field, NULL);
+            unsigned int tail = this->captureTail;
+            if(tail == capturedHead())
+            {
+                return false;
+            }
+            sample = this->captureBuffer[tail];
+            captureBarrier();
+            setCapturedTail((tail + 1 == this->captureSize) ? 0 : tail + 1);
+            return true;
         }
-
-         
+        
+        
         /*
-        Function: readFloatField
+        Function: stageCapturedFields
         
         Summary:
-        ead the latest floating point value from a private ThingSpeak channel
-        
-        Parameters:
-        channelNumber - Channel number
-        field - Field number (1-8) within the channel to read from.
-        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        Set the values waiting in the capture buffer as fields of the next update, as if setField() had been called with them in the order they were captured.
         
         Returns:
-        Value read, or 0 if the field is text or there is an error.  Use getLastReadStatus() to get more specific information.  Note that NAN, INFINITY, and -INFINITY are valid results.
+        Number of values taken from the capture buffer
+        
+        Notes:
+        Call it from loop() before writeFields() or queueFields().  When a field was captured more than once, the latest value is written; every value is added to the history of the field set with setFieldSeries().
         */
-        float readFloatField(unsigned long channelNumber, unsigned int field, const char * readAPIKey)
+        unsigned int stageCapturedFields()
         {
-            return convertStringToFloat(readStringField(channelNumber, field, readAPIKey));
+            capturedSample sample;
+            unsigned int count = 0;
+            while(readCapturedSample(sample))
+            {
+                if(sample.isFloat)
+                {
+                    setField(sample.field, sample.number);
+                }
+                else
+                {
+                    setField(sample.field, sample.integer);
+                }
+                count++;
+            }
+            return count;
         }
-
+        
         
         /*
-        Function: readFloatField
+        Function: getCaptureDropped
         
         Summary:
-        Read the latest floating point value from a public ThingSpeak channel
-        
-        Parameters:
-        channelNumber - Channel number
-        field - Field number (1-8) within the channel to read from.
+        Get the number of values dropped by captureField() because the capture buffer was full, since setCaptureBuffer() was called.
         
         Returns:
-        Value read, or 0 if the field is text or there is an error.  Use getLastReadStatus() to get more specific information.  Note that NAN, INFINITY, and -INFINITY are valid results.
+        Number of dropped values
         */
-        float readFloatField(unsigned long channelNumber, unsigned int field)
+        unsigned long getCaptureDropped()
         {
-            return readFloatField(channelNumber, field, NULL);
+            #if defined(__AVR__)
+                // the interrupt may count a dropped value between the four loads
+                uint8_t oldSREG = SREG;
+                cli();
+                unsigned long dropped = this->captureDropped;
+                SREG = oldSREG;
+                return dropped;
+            #else
+                return this->captureDropped;
+            #endif
         }
 
-         
+        
         /*
-        Function: readLongField
+        Function: setFieldSchedule
         
         Summary:
-        Read the latest long value from a private ThingSpeak channel
+        Set when a field has to be written by serviceSchedule(): at least every periodMS, as soon as its value changes, or both.
         
         Parameters:
-        channelNumber - Channel number
-        field - Field number (1-8) within the channel to read from.
-        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        field - Field number (1-8) to schedule.
+        schedule - fieldSchedule created earlier in the sketch with periodMS and onChange set, or NULL to stop scheduling the field.
         
         Returns:
-        Value read, or 0 if the field is text or there is an error.  Use getLastReadStatus() to get more specific information.  Note that NAN, INFINITY, and -INFINITY are valid results.
+        Code of 200 if successful.
+        Code of -201 if the field number is invalid.
+        
+        Notes:
+        A scheduled field is due as soon as it is set for the first time.
         */
-        long readLongField(unsigned long channelNumber, unsigned int field, const char * readAPIKey)
+        int setFieldSchedule(unsigned int field, fieldSchedule * schedule)
         {
-            // Note that although the function is called "toInt" it really returns a long.
-            return readStringField(channelNumber, field, readAPIKey).toInt();
+            if(field < FIELDNUM_MIN || field > FIELDNUM_MAX) return TS_ERR_INVALID_FIELD_NUM;
+            
+            if(NULL != schedule)
+            {
+                schedule->written = false;
+                schedule->pending = false;
+                schedule->misses = 0;
+            }
+            this->fieldSchedules[field - 1] = schedule;
+            
+            return TS_OK_SUCCESS;
         }
-
-         
+        
+        
         /*
-        Function: readLongField
+        Function: setScheduleInterval
         
         Summary:
-        Read the latest long value from a public ThingSpeak channel
+        Set the shortest time between two updates written by serviceSchedule().
         
         Parameters:
-        channelNumber - Channel number
-        field - Field number (1-8) within the channel to read from.
+        intervalMS - Time in milliseconds, 15000 (the default) for a free account.
         
         Returns:
-        Value read, or 0 if the field is text or there is an error.  Use getLastReadStatus() to get more specific information.  Note that NAN, INFINITY, and -INFINITY are valid results.
+        Always returns true
         */
-        long readLongField(unsigned long channelNumber, unsigned int field)
+        bool setScheduleInterval(unsigned long intervalMS)
         {
-            return readLongField(channelNumber, field, NULL);
+            this->scheduleInterval = intervalMS;
+            return true;
         }
-
-         
+        
+        
         /*
-        Function: readIntField
+        Function: serviceSchedule
         
         Summary:
-        Read the latest int value from a private ThingSpeak channel
+        Write the fields set with setField() when one of the scheduled fields is due and the channel may be written again.
         
         Parameters:
         channelNumber - Channel number
-        field - Field number (1-8) within the channel to read from.
-        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        writeAPIKey - Write API key associated with the channel.  *If you share code with others, do _not_ share this key*
         
         Returns:
-        Value read, or 0 if the field is text or there is an error.  Use getLastReadStatus() to get more specific information.  Note that NAN, INFINITY, and -INFINITY are valid results.
+        200 - successful.
+        -501 - No scheduled field is due, or the interval has not passed since the last update
+        See writeFields() for other possible return values.
+        
+        Notes:
+        Call it often from loop(), and set the fields with setField() whenever new values are read.  Nothing is written until a scheduled field is due: a field with a period when the period has passed since it was last written, a field with onChange when it was set to a value that differs from the last written one.
+        Every update carries all fields that are set, so fields that are not due yet ride along with the due one and their period starts again.  That way the fields share as few updates as their deadlines allow.
+        A scheduled field that is written more than SCHEDULE_TOLERANCE_MS after its deadline, because of the interval between updates or a failed write, counts as a miss, see getScheduleMisses().
         */
-        int readIntField(unsigned long channelNumber, unsigned int field, const char * readAPIKey)
+        int serviceSchedule(unsigned long channelNumber, const char * writeAPIKey)
         {
-            return readLongField(channelNumber, field, readAPIKey);
+            unsigned long now = millis();
+            bool due = false;
+            unsigned long valueHash[FIELDNUM_MAX];
+            uint8_t sent = 0; // the fields that go out with the update
+            lockStaging();
+            writeStaging & staged = nextWrite();
+            for(size_t iField = 0; iField < FIELDNUM_MAX; iField++)
+            {
+                fieldSchedule * schedule = this->fieldSchedules[iField];
+                if(NULL == schedule || 0 == staged.field[iField].length())
+                {
+                    continue;
+                }
+                sent |= (1 << iField);
+                valueHash[iField] = hashReadCacheKey(staged.field[iField].c_str());
+                if(!schedule->pending)
+                {
+                    bool periodDue = schedule->written && schedule->periodMS > 0 && now - schedule->lastWriteAt >= schedule->periodMS;
+                    bool changed = schedule->written && schedule->onChange && valueHash[iField] != schedule->lastValueHash;
+                    if(!schedule->written || periodDue || changed)
+                    {
+                        schedule->pending = true;
+                        schedule->dueAt = periodDue ? schedule->lastWriteAt + schedule->periodMS : now;
+                    }
+                }
+                due = due || schedule->pending;
+            }
+            unlockStaging();
+            if(!due || (this->scheduleWritten && now - this->scheduleLastWrite < this->scheduleInterval))
+            {
+                return TS_ERR_QUEUE_EMPTY;
+            }
+            
+            int status = writeFields(channelNumber, writeAPIKey);
+            this->scheduleWritten = true;
+            this->scheduleLastWrite = now;
+            if(status != TS_OK_SUCCESS)
+            {
+                return status;
+            }
+            
+            for(size_t iField = 0; iField < FIELDNUM_MAX; iField++)
+            {
+                fieldSchedule * schedule = this->fieldSchedules[iField];
+                if(0 == (sent & (1 << iField)))
+                {
+                    continue;
+                }
+                if(schedule->pending && (long)(now - schedule->dueAt) > SCHEDULE_TOLERANCE_MS)
+                {
+                    schedule->misses++;
+                }
+                schedule->pending = false;
+                schedule->written = true;
+                schedule->lastWriteAt = now;
+                schedule->lastValueHash = valueHash[iField];
+            }
+            
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::serviceSchedule (fields: 0x"); Serial.print(sent, HEX); Serial.print(" misses: "); Serial.print(getScheduleMisses()); Serial.println(")");
+            #endif
+            
+            return status;
         }
-
-         
+        
+        
         /*
-        Function: readIntField
+        Function: getScheduleMisses
         
         Summary:
-        Read the latest int value from a public ThingSpeak channel
-        
-        Parameters:
-        channelNumber - Channel number
-        field - Field number (1-8) within the channel to read from.
+        Get the number of times scheduled fields were written later than their deadline, since setFieldSchedule() was called for them.
         
         Returns:
-        Value read, or 0 if the field is text or there is an error.  Use getLastReadStatus() to get more specific information.  Note that NAN, INFINITY, and -INFINITY are valid results.
+        Number of misses of all scheduled fields, see the misses of each fieldSchedule for a single field
         */
-        int readIntField(unsigned long channelNumber, unsigned int field)
+        unsigned long getScheduleMisses()
         {
-            return readLongField(channelNumber, field, NULL);
+            unsigned long misses = 0;
+            for(size_t iField = 0; iField < FIELDNUM_MAX; iField++)
+            {
+                if(NULL != this->fieldSchedules[iField])
+                {
+                    misses += this->fieldSchedules[iField]->misses;
+                }
+            }
+            return misses;
         }
-
-
+        
+     
         /*
-        Function: readStatus
+        Function: writeFields
         
         Summary:
-        Read the latest status from a private ThingSpeak channel
+        Write a multi-field update.
         
         Parameters:
         channelNumber - Channel number
-        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        writeAPIKey - Write API key associated with the channel.  *If you share code with others, do _not_ share this key*
         
-        Results:
-        Value read (UTF8 string). An empty string is returned if there was no status written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
+        Returns:
+        200 - successful.
+        404 - Incorrect API key (or invalid ThingSpeak server address)
+        -101 - Value is out of range or string is too long (> 255 characters)
+        -201 - Invalid field number specified
+        -210 - setField() was not called before writeFields()
+        -301 - Failed to connect to ThingSpeak
+        -302 - Unexpected failure during write to ThingSpeak
+        -303 - Unable to parse response
+        -304 - Timeout waiting for server to respond
+        -401 - Point was not inserted (most probable cause is the rate limit of once every 15 seconds)
+        
+        Notes:
+        Call setField(), setLatitude(), setLongitude(), setElevation() and/or setStatus() and then call writeFields()
+        The values are taken when the update is sent, so values set meanwhile, for example from another task, are kept for the next update.
         */
-        String readStatus(unsigned long channelNumber, const char * readAPIKey)
+        int writeFields(unsigned long channelNumber, const char * writeAPIKey)
         {
-            String content = readRaw(channelNumber, "/feeds/last.txt?status=true", readAPIKey);
+            invalidateReadCache(channelNumber);
             
-            if(getLastReadStatus() != TS_OK_SUCCESS){
-                return String("");
+            if(!connectThingSpeak()){
+                // Failed to connect to ThingSpeak
+                return TS_ERR_CONNECT_FAILED;
             }
             
-            return getJSONValueByKey(content, "status");
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::writeFields   (channelNumber: "); Serial.print(channelNumber); Serial.print(" writeAPIKey: "); Serial.println(writeAPIKey);
+            #endif
+            
+            // Take the staged values, new values go to the other staging slot while these are sent
+            writeStaging & sending = takeStagedWrite();
+            
+            int status = writeStagedUpdate(writeAPIKey, sending);
+            if(resendOnNewConnection(status))
+            {
+                status = connectThingSpeak() ? writeStagedUpdate(writeAPIKey, sending) : TS_ERR_CONNECT_FAILED;
+            }
+            clearStagedWrite(sending);
+            
+            return status;
         }
-        
+
          
         /*
-        Function: readStatus
+        Function: writeRaw
         
         Summary:
-        Read the latest status from a public ThingSpeak channel
+        Write a raw POST to a ThingSpeak channel
         
         Parameters:
         channelNumber - Channel number
+        postMessage - Raw URL to write to ThingSpeak as a string.  See the documentation at https://thingspeak.com/docs/channels#update_feed.
+        writeAPIKey - Write API key associated with the channel.  *If you share code with others, do _not_ share this key*
         
-        Results:
-        Value read (UTF8 string). An empty string is returned if there was no status written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
+        Returns:
+        200 - successful.
+        404 - Incorrect API key (or invalid ThingSpeak server address)
+        -101 - Value is out of range or string is too long (> 255 characters)
+        -201 - Invalid field number specified
+        -210 - setField() was not called before writeFields()
+        -301 - Failed to connect to ThingSpeak
+        -302 - Unexpected failure during write to ThingSpeak
+        -303 - Unable to parse response
+        -304 - Timeout waiting for server to respond
+        -401 - Point was not inserted (most probable cause is the rate limit of once every 15 seconds)
+        
+        Notes:
+        This is low level functionality that will not be required by most users.  The values set with setField() and the like are not cleared, they are kept for the next writeFields().
         */
-        String readStatus(unsigned long channelNumber)
+        int writeRaw(unsigned long channelNumber, String postMessage, const char * writeAPIKey)
         {
-            return readStatus(channelNumber, NULL);
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::writeRaw   (channelNumber: "); Serial.print(channelNumber); Serial.print(" writeAPIKey: "); Serial.println(writeAPIKey);
+            #endif
+
+            invalidateReadCache(channelNumber);
+
+            postMessage.concat("&headers=false");
+            
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("               POST \"");Serial.print(postMessage);Serial.println("\"");
+            #endif
+
+            int status = postUpdate(writeAPIKey, postMessage);
+            if(resendOnNewConnection(status))
+            {
+                status = postUpdate(writeAPIKey, postMessage);
+            }
+            
+            return status;
         }
         
-
+         
         /*
-        Function: readCreatedAt
+        Function: setUpdateQueue
         
         Summary:
-        Read the created-at timestamp associated with the latest update to a private ThingSpeak channel
+        Set the storage for updates that are collected with queueFields() and sent together with writeQueuedFields().
         
         Parameters:
-        channelNumber - Channel number
-        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        updates - Array of queuedUpdate created earlier in the sketch, or NULL to stop queueing.
+        numUpdates - Number of elements in updates.
         
-        Results:
-        Value read (UTF8 string). An empty string is returned if there was no created-at timestamp written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
+        Returns:
+        Always returns true
+        
+        Notes:
+        Queued values are stored as numbers, so an update takes the same space whatever its values are.  When the queue is full the oldest update is dropped.
+        serviceUpdateQueue() writes at most once every 15 seconds, the update limit of a free account.
         */
-        String readCreatedAt(unsigned long channelNumber, const char * readAPIKey)
+        bool setUpdateQueue(queuedUpdate * updates, unsigned int numUpdates)
         {
-            String content = readRaw(channelNumber, "/feeds/last.txt", readAPIKey);
-            
-            if(getLastReadStatus() != TS_OK_SUCCESS){
-                return String("");
-            }
-            
-            return getJSONValueByKey(content, "created_at");
+            return setUpdateQueue(updates, numUpdates, GATEWAY_INTERVAL_MS);
         }
-
+        
         
         /*
-        Function: readCreatedAt
+        Function: setUpdateQueue
         
         Summary:
-        Read the created-at timestamp associated with the latest update to a public ThingSpeak channel
+        Set the storage for updates that are collected with queueFields() and sent together with writeQueuedFields() or serviceUpdateQueue().
         
         Parameters:
-        channelNumber - Channel number
-            
-        Results:
-        Value read (UTF8 string). An empty string is returned if there was no created-at timestamp written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
+        updates - Array of queuedUpdate created earlier in the sketch, or NULL to stop queueing.
+        numUpdates - Number of elements in updates.
+        intervalMS - Shortest time between two writes of serviceUpdateQueue() in milliseconds, 15000 for a free account.
+        
+        Returns:
+        Always returns true
+        
+        Notes:
+        The queue is emptied and the lane latencies are reset.  An urgent update that is still waiting is kept.
         */
-        String readCreatedAt(unsigned long channelNumber)
+        bool setUpdateQueue(queuedUpdate * updates, unsigned int numUpdates, unsigned long intervalMS)
         {
-            return readCreatedAt(channelNumber, NULL);
+            this->updateQueue = updates;
+            this->updateQueueSize = (NULL == updates) ? 0 : numUpdates;
+            this->updateQueueStart = 0;
+            this->updateQueueCount = 0;
+            this->updateQueueDropped = 0;
+            this->updateQueueInterval = intervalMS;
+            this->updateQueueWritten = false;
+            for(size_t iLane = 0; iLane < 2; iLane++)
+            {
+                this->laneLatency[iLane] = 0;
+                this->laneMaxLatency[iLane] = 0;
+            }
+            return true;
         }
-           
-            
+
+
         /*
-        Function: readRaw
+        Function: queueFields
         
         Summary:
-        Read a raw response from a private ThingSpeak channel
-        
-        Parameters:
-        channelNumber - Channel number
-        suffixURL - Raw URL to write to ThingSpeak as a String.  See the documentation at https://thingspeak.com/docs/channels#get_feed
-        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        Add the fields set with setField() to the update queue, timestamped with the current time, instead of writing them right away.
         
         Returns:
-        Response if successful, or empty string. Use getLastReadStatus() to get more specific information.
+        200 - successful.
+        -210 - setField() was not called before queueFields()
+        -501 - setUpdateQueue() was not called before queueFields()
         
         Notes:
-        This is low level functionality that will not be required by most users.
+        Only numeric field values are queued.  The fields are cleared afterwards, like after writeFields().
         */
-        String readRaw(unsigned long channelNumber, String suffixURL, const char * readAPIKey)
+        int queueFields()
         {
-            #ifdef PRINT_DEBUG_MESSAGES
-                Serial.print("ts::readRaw   (channelNumber: "); Serial.print(channelNumber);
-                if(NULL != readAPIKey)
-                {
-                    Serial.print(" readAPIKey: "); Serial.print(readAPIKey);
-                }
-                Serial.print(" suffixURL: \""); Serial.print(suffixURL); Serial.println("\")");
-            #endif
-
-            if(!connectThingSpeak())
+            if(0 == this->updateQueueSize)
             {
-                this->lastReadStatus = TS_ERR_CONNECT_FAILED;
-                return String("");
+                return TS_ERR_QUEUE_EMPTY;
             }
-
-            String readURL = String("/channels/");
-            readURL.concat(channelNumber);
-            readURL.concat(suffixURL);
-            
-            #ifdef PRINT_DEBUG_MESSAGES
-                Serial.print("               GET \"");Serial.print(readURL);Serial.println("\"");
-            #endif
-
-            // Get data from thingspeak
-            if(!this->client->print("GET ")) return abortReadRaw();
-            if(!this->client->print(readURL)) return abortReadRaw();
-            if(!this->client->print(" HTTP/1.1\r\n")) return abortReadRaw();
-            if(!writeHTTPHeader(readAPIKey)) return abortReadRaw();
-            if(!this->client->print("\r\n")) return abortReadRaw();
             
-            String content = String();
-            int status = getHTTPResponse(content);
-                
-            this->lastReadStatus = status;
-            
-            emptyStream();
+            int status = appendQueuedUpdate(this->updateQueue, this->updateQueueSize, this->updateQueueStart, this->updateQueueCount, this->updateQueueDropped);
+            if(status != TS_OK_SUCCESS)
+            {
+                return status;
+            }
             
             #ifdef PRINT_DEBUG_MESSAGES
-                if(status == TS_OK_SUCCESS)
-                {
-                    Serial.print("Read: \""); Serial.print(content); Serial.println("\"");
-                }
-            #endif
-                    
-            this->client->stop();
-            #ifdef PRINT_DEBUG_MESSAGES
-                Serial.println("disconnected.");
+                Serial.print("ts::queueFields (queued: "); Serial.print(this->updateQueueCount); Serial.println(")");
             #endif
+            
+            return status;
+        }
 
-            if(status != TS_OK_SUCCESS)
-            {
-                return String("");
-            }
 
-            return content;
+        /*
+        Function: getQueuedCount
+        
+        Summary:
+        Get the number of updates waiting in the update queue.
+        
+        Returns:
+        Number of queued updates
+        */
+        unsigned int getQueuedCount()
+        {
+            return this->updateQueueCount;
         }
+
+
+        /*
+        Function: getQueueDropped
         
+        Summary:
+        Get the number of updates dropped because the update queue was full, since setUpdateQueue() was called.
         
+        Returns:
+        Number of dropped updates
+        */
+        unsigned long getQueueDropped()
+        {
+            return this->updateQueueDropped;
+        }
+
+
         /*
-        Function: readRaw
-           
+        Function: setQueueOverflow
+        
         Summary:
-        Read a raw response from a public ThingSpeak channel
-           
+        Select what happens when an update is queued on a full update queue.
+        
         Parameters:
-        channelNumber - Channel number
-        suffixURL - Raw URL to write to ThingSpeak as a String.  See the documentation at https://thingspeak.com/docs/channels#get_feed
-           
+        policy - TS_QUEUE_DROP_OLDEST (default) or TS_QUEUE_DECIMATE.
+        
         Returns:
-        Response if successful, or empty string. Use getLastReadStatus() to get more specific information.
-           
+        Code of 200 if successful.
+        Code of -101 if the policy is unknown.
+        
         Notes:
-        This is low level functionality that will not be required by most users.
+        With TS_QUEUE_DECIMATE the two oldest updates of the finest resolution in the queue are merged into one, timestamped halfway between them, with the values set with setFieldDecimation().
+        The queue then keeps covering the whole outage, at a resolution that halves, oldest updates first, each time the queue fills up again.  Only updates that already merge 32768 updates are dropped.
+        Applies to the update queue and to the queues of the gateway channels.
         */
-        String readRaw(unsigned long channelNumber, String suffixURL)
+        int setQueueOverflow(int policy)
         {
-            return readRaw(channelNumber, suffixURL, NULL);
+            if(policy != TS_QUEUE_DROP_OLDEST && policy != TS_QUEUE_DECIMATE) return TS_ERR_OUT_OF_RANGE;
+            this->queueOverflow = policy;
+            
+            return TS_OK_SUCCESS;
         }
+
+
+        /*
+        Function: setFieldDecimation
         
+        Summary:
+        Select which value of a field an update keeps when two queued updates are merged.
         
-        #ifndef ARDUINO_AVR_UNO // Arduino Uno doesn't have enough memory to perform the following functionalities.
-            
-            /*
-            Function: readMultipleFields
-             
-            Summary:
-            Read all the field values, status message, location coordinates, and created-at timestamp associated with the latest feed to a private ThingSpeak channel and store the values locally in variables within a struct.
-             
-            Parameters:
-            channelNumber - Channel number
-            readAPIKey - Read API key associated with the channel. *If you share code with others, do _not_ share this key*
-             
-            Returns:
-            HTTP status code of 200 if successful.
+        Parameters:
+        field - Field number (1-8) within the channel.
+        mode - TS_DECIMATE_MEAN (default), TS_DECIMATE_MIN or TS_DECIMATE_MAX.
+        
+        Returns:
+        Code of 200 if successful.
+        Code of -101 if the mode is unknown.
+        Code of -201 if the field number is out of range.
+        
+        Notes:
+        Use TS_DECIMATE_MAX for a field like a peak or an alarm, whose extremes must survive the decimation.  A field that was set in only one of the updates keeps that value.
+        */
+        int setFieldDecimation(unsigned int field, int mode)
+        {
+            if(field < FIELDNUM_MIN || field > FIELDNUM_MAX) return TS_ERR_INVALID_FIELD_NUM;
+            if(mode != TS_DECIMATE_MEAN && mode != TS_DECIMATE_MIN && mode != TS_DECIMATE_MAX) return TS_ERR_OUT_OF_RANGE;
+            this->fieldDecimation[field - 1] = mode;
             
-            Notes:
-            See getLastReadStatus() for other possible return values.
-            */
-            int readMultipleFields(unsigned long channelNumber, const char * readAPIKey)
+            return TS_OK_SUCCESS;
+        }
+
+
+        /*
+        Function: getQueueCoverage
+        
+        Summary:
+        Get the time covered by the update queue.
+        
+        Returns:
+        Milliseconds from the oldest to the newest queued update, 0 when fewer than two updates are queued
+        */
+        unsigned long getQueueCoverage()
+        {
+            if(this->updateQueueCount < 2)
+            {
+                return 0;
+            }
+            uint32_t newest = this->updateQueue[(this->updateQueueStart + this->updateQueueCount - 1) % this->updateQueueSize].time;
+            return newest - this->updateQueue[this->updateQueueStart].time;
+        }
+
+
+        /*
+        Function: getQueueDecimation
+        
+        Summary:
+        Get the effective resolution of the oldest part of the update queue.
+        
+        Returns:
+        Most updates merged into one queued update, 1 if the queue was not decimated, 0 if the queue is empty
+        
+        Notes:
+        A result of 8 means that the oldest queued updates keep one eighth of the updates that were queued at the time.  The newest updates always have the finest resolution.
+        */
+        unsigned int getQueueDecimation()
+        {
+            unsigned int decimation = 0;
+            for(unsigned int i = 0; i < this->updateQueueCount; i++)
+            {
+                uint16_t samples = this->updateQueue[(this->updateQueueStart + i) % this->updateQueueSize].samples;
+                if(samples > decimation) decimation = samples;
+            }
+            return decimation;
+        }
+
+
+        /*
+        Function: writeQueuedFields
+        
+        Summary:
+        Write the queued updates to a ThingSpeak channel with one bulk update.
+        
+        Parameters:
+        channelNumber - Channel number
+        writeAPIKey - Write API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        
+        Returns:
+        200 - successful, the updates that were sent are removed from the queue.
+        -501 - There are no queued updates
+        See writeFields() for other possible return values.
+        
+        Notes:
+        The updates are sent as CSV with time offsets in seconds between updates (time_format=relative), which is much smaller than JSON with a timestamp per update.
+        The body is printed straight from the queue: it is printed once to count the Content-Length, then again to the connection.
+        At most 960 updates are sent in one call.
+        */
+        int writeQueuedFields(unsigned long channelNumber, const char * writeAPIKey)
+        {
+            if(0 == this->updateQueueCount)
+            {
+                return TS_ERR_QUEUE_EMPTY;
+            }
+            
+            return writeBulkUpdate(channelNumber, writeAPIKey, this->updateQueue, this->updateQueueSize, this->updateQueueStart, this->updateQueueCount, false);
+        }
+
+
+        /*
+        Function: queueUrgentFields
+        
+        Summary:
+        Hold the fields, location and status set with setField(), setLatitude(), setStatus() and the like as an urgent update, which serviceUpdateQueue() sends before the queued updates.
+        
+        Returns:
+        200 - successful.
+        -210 - No value was set before queueUrgentFields()
+        
+        Notes:
+        Unlike queueFields(), text values and the status are kept as they are.  There is one urgent update: values set again before it was sent replace the waiting ones, other waiting values are kept.
+        The values set are cleared afterwards, like after writeFields().
+        */
+        int queueUrgentFields()
+        {
+            writeStaging & staged = takeStagedWrite();
+            if(0 == getWriteFieldsContentLength(staged))
+            {
+                clearStagedWrite(staged);
+                return TS_ERR_SETFIELD_NOT_CALLED;
+            }
+            
+            for(size_t iField = 0; iField < FIELDNUM_MAX; iField++)
+            {
+                if(staged.field[iField].length() > 0) this->urgentWrite.field[iField] = staged.field[iField];
+            }
+            if(!isnan(staged.latitude)) this->urgentWrite.latitude = staged.latitude;
+            if(!isnan(staged.longitude)) this->urgentWrite.longitude = staged.longitude;
+            if(!isnan(staged.elevation)) this->urgentWrite.elevation = staged.elevation;
+            if(staged.status.length() > 0) this->urgentWrite.status = staged.status;
+            if(staged.createdAt.length() > 0) this->urgentWrite.createdAt = staged.createdAt;
+            clearStagedWrite(staged);
+            
+            if(!this->urgentPending)
+            {
+                this->urgentPending = true;
+                this->urgentQueuedAt = millis();
+            }
+            
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.println("ts::queueUrgentFields");
+            #endif
+            
+            return TS_OK_SUCCESS;
+        }
+
+
+        /*
+        Function: isUrgentPending
+        
+        Summary:
+        Find out whether an urgent update queued with queueUrgentFields() is waiting to be sent.
+        
+        Returns:
+        true when an urgent update is waiting
+        */
+        bool isUrgentPending()
+        {
+            return this->urgentPending;
+        }
+
+
+        /*
+        Function: serviceUpdateQueue
+        
+        Summary:
+        Send the urgent update if there is one, otherwise the queued updates with one bulk update, when the rate limit allows another write.
+        
+        Parameters:
+        channelNumber - Channel number
+        writeAPIKey - Write API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        
+        Returns:
+        200 - successful, the update that was sent is removed from its lane.
+        -501 - Nothing is waiting, or the interval given to setUpdateQueue() has not passed since the last write
+        See writeFields() and writeQueuedFields() for other possible return values.
+        
+        Notes:
+        Call it often from loop().  Each call sends at most one request, so it never blocks for longer than one write.
+        The urgent lane takes the next write slot, even while the queue needs several bulk updates of 960 updates to empty, and the queue gets the slots that are left.
+        A failed write uses up its slot like a successful one; a failed urgent update is kept and tried again in the next slot.
+        Use getLaneLatency() to find out how long updates waited in each lane.
+        */
+        int serviceUpdateQueue(unsigned long channelNumber, const char * writeAPIKey)
+        {
+            unsigned long now = millis();
+            if((!this->urgentPending && 0 == this->updateQueueCount) || (this->updateQueueWritten && now - this->updateQueueLastWrite < this->updateQueueInterval))
+            {
+                return TS_ERR_QUEUE_EMPTY;
+            }
+            
+            int status;
+            if(this->urgentPending)
+            {
+                status = writeUrgentUpdate(channelNumber, writeAPIKey);
+                
+                if(resendOnNewConnection(status))
+                {
+                    status = writeUrgentUpdate(channelNumber, writeAPIKey);
+                }
+                if(status == TS_OK_SUCCESS)
+                {
+                    recordLaneLatency(TS_LANE_URGENT, millis() - this->urgentQueuedAt);
+                    clearStagedWrite(this->urgentWrite);
+                    this->urgentPending = false;
+                }
+            }
+            else
+            {
+                uint32_t oldest = this->updateQueue[this->updateQueueStart].time;
+                status = writeBulkUpdate(channelNumber, writeAPIKey, this->updateQueue, this->updateQueueSize, this->updateQueueStart, this->updateQueueCount, false);
+                if(resendOnNewConnection(status))
+                {
+                    status = writeBulkUpdate(channelNumber, writeAPIKey, this->updateQueue, this->updateQueueSize, this->updateQueueStart, this->updateQueueCount, false);
+                }
+                if(status == TS_OK_SUCCESS)
+                {
+                    recordLaneLatency(TS_LANE_BULK, millis() - oldest);
+                }
+            }
+            this->updateQueueLastWrite = now;
+            this->updateQueueWritten = true;
+            return status;
+        }
+
+
+        /*
+        Function: getLaneLatency
+        
+        Summary:
+        Get how long the update sent last by serviceUpdateQueue() in a lane had waited.
+        
+        Parameters:
+        lane - TS_LANE_URGENT or TS_LANE_BULK
+        
+        Returns:
+        Milliseconds from queueing to the end of the write, for the bulk lane from queueing the oldest update that was sent, or 0 if nothing was sent in the lane yet
+        */
+        unsigned long getLaneLatency(int lane)
+        {
+            return (lane == TS_LANE_URGENT || lane == TS_LANE_BULK) ? this->laneLatency[lane] : 0;
+        }
+
+
+        /*
+        Function: getLaneMaxLatency
+        
+        Summary:
+        Get the longest wait of an update sent by serviceUpdateQueue() in a lane, since setUpdateQueue() was called.
+        
+        Parameters:
+        lane - TS_LANE_URGENT or TS_LANE_BULK
+        
+        Returns:
+        Longest latency in milliseconds, see getLaneLatency()
+        */
+        unsigned long getLaneMaxLatency(int lane)
+        {
+            return (lane == TS_LANE_URGENT || lane == TS_LANE_BULK) ? this->laneMaxLatency[lane] : 0;
+        }
+
+
+        /*
+        Function: setGatewayChannels
+        
+        Summary:
+        Set the channels that a gateway writes to, each with its own update queue, for queueChannelFields() and serviceGateway().
+        
+        Parameters:
+        channels - Array of gatewayChannel created earlier in the sketch, with channelNumber, writeAPIKey, updates and capacity set, or NULL to stop.
+        numChannels - Number of elements in channels.
+        intervalMS - Shortest time between two writes to the same channel in milliseconds, 15000 for a free account.
+        
+        Returns:
+        Always returns true
+        
+        Notes:
+        The queues of all channels are emptied.  Every channel may be written right away.
+        */
+        bool setGatewayChannels(gatewayChannel * channels, unsigned int numChannels, unsigned long intervalMS)
+        {
+            this->gatewayChannels = channels;
+            this->numGatewayChannels = (NULL == channels) ? 0 : numChannels;
+            this->gatewayInterval = intervalMS;
+            this->gatewayNext = 0;
+            for(unsigned int i = 0; i < this->numGatewayChannels; i++)
+            {
+                this->gatewayChannels[i].start = 0;
+                this->gatewayChannels[i].count = 0;
+                this->gatewayChannels[i].dropped = 0;
+                this->gatewayChannels[i].lastWriteAt = millis() - intervalMS;
+            }
+            return true;
+        }
+
+
+        /*
+        Function: setGatewayChannels
+        
+        Summary:
+        Set the channels that a gateway writes to, each with its own update queue, for queueChannelFields() and serviceGateway().
+        
+        Parameters:
+        channels - Array of gatewayChannel created earlier in the sketch, with channelNumber, writeAPIKey, updates and capacity set, or NULL to stop.
+        numChannels - Number of elements in channels.
+        
+        Returns:
+        Always returns true
+        
+        Notes:
+        A channel is written at most once every 15 seconds, the update limit of a free account.
+        */
+        bool setGatewayChannels(gatewayChannel * channels, unsigned int numChannels)
+        {
+            return setGatewayChannels(channels, numChannels, GATEWAY_INTERVAL_MS);
+        }
+
+
+        /*
+        Function: queueChannelFields
+        
+        Summary:
+        Add the fields set with setField() to the update queue of one of the gateway channels.
+        
+        Parameters:
+        channelNumber - Channel number, one of the channels set with setGatewayChannels()
+        
+        Returns:
+        200 - successful.
+        -210 - setField() was not called before queueChannelFields()
+        -501 - The channel is not a gateway channel
+        
+        Notes:
+        Works like queueFields(): only numeric field values are queued, the fields are cleared afterwards, and the oldest update is dropped when the queue is full.
+        */
+        int queueChannelFields(unsigned long channelNumber)
+        {
+            gatewayChannel * channel = findGatewayChannel(channelNumber);
+            if(NULL == channel || 0 == channel->capacity)
+            {
+                resetWriteFields();
+                return TS_ERR_QUEUE_EMPTY;
+            }
+            return appendQueuedUpdate(channel->updates, channel->capacity, channel->start, channel->count, channel->dropped);
+        }
+
+
+        /*
+        Function: serviceGateway
+        
+        Summary:
+        Write the queued updates of the next gateway channel that has updates and may be written again, with one bulk update.
+        
+        Returns:
+        200 - successful, the updates that were sent are removed from the queue of the channel.
+        -501 - No channel has queued updates that may be written now
+        See writeFields() for other possible return values.
+        
+        Notes:
+        Call it often from loop().  Each call sends at most one request, so it never blocks for longer than one write.
+        The channels are taken in turn, so a busy channel doesn't hold back the others, and a channel is not written again before the interval given to setGatewayChannels() has passed, whether the last write succeeded or not.
+        With setKeepAlive(true) all channels are written over the same connection.
+        Use getGatewayChannel() to find out which channel was written.
+        */
+        int serviceGateway()
+        {
+            unsigned long now = millis();
+            for(unsigned int i = 0; i < this->numGatewayChannels; i++)
+            {
+                unsigned int index = (this->gatewayNext + i) % this->numGatewayChannels;
+                gatewayChannel & channel = this->gatewayChannels[index];
+                if(0 == channel.count || now - channel.lastWriteAt < this->gatewayInterval)
+                {
+                    continue;
+                }
+                
+                this->gatewayNext = (index + 1) % this->numGatewayChannels;
+                this->gatewayLast = channel.channelNumber;
+                int status = writeBulkUpdate(channel.channelNumber, channel.writeAPIKey, channel.updates, channel.capacity, channel.start, channel.count, false);
+                
+                if(resendOnNewConnection(status))
+                {
+                    status = writeBulkUpdate(channel.channelNumber, channel.writeAPIKey, channel.updates, channel.capacity, channel.start, channel.count, false);
+                }
+                channel.lastWriteAt = now;
+                return status;
+            }
+            return TS_ERR_QUEUE_EMPTY;
+        }
+
+
+        /*
+        Function: getGatewayChannel
+        
+        Summary:
+        Get the channel that the last serviceGateway() wrote to.
+        
+        Returns:
+        Channel number, or 0 if serviceGateway() has not written yet
+        */
+        unsigned long getGatewayChannel()
+        {
+            return this->gatewayLast;
+        }
+
+
+        /*
+        Function: getGatewayQueuedCount
+        
+        Summary:
+        Get the number of updates waiting in the queues of all gateway channels.
+        
+        Returns:
+        Number of queued updates
+        */
+        unsigned long getGatewayQueuedCount()
+        {
+            unsigned long count = 0;
+            for(unsigned int i = 0; i < this->numGatewayChannels; i++)
+            {
+                count += this->gatewayChannels[i].count;
+            }
+            return count;
+        }
+
+
+        /*
+        Function: beginBackfill
+        
+        Summary:
+        Start or resume writing a CSV log, like a file kept on an SD card while the network was down, to a ThingSpeak channel with serviceBackfill().
+        
+        Parameters:
+        job - backfillJob created earlier in the sketch, with channelNumber, writeAPIKey, updates, capacity and offset set.  offset is 0 for a new log, or the offset saved after the last successful serviceBackfill().
+        intervalMS - Shortest time between two bulk updates in milliseconds, 15000 for a free account.
+        
+        Returns:
+        Always returns true
+        
+        Notes:
+        The log must be positioned at job.offset when serviceBackfill() first reads it, for a File with log.seek(job.offset).
+        */
+        bool beginBackfill(backfillJob & job, unsigned long intervalMS)
+        {
+            job.readOffset = job.offset;
+            job.count = 0;
+            job.rowsWritten = 0;
+            job.rowsSkipped = 0;
+            job.interval = intervalMS;
+            job.startedAt = millis();
+            job.lastWriteAt = job.startedAt - intervalMS;
+            job.ended = false;
+            return true;
+        }
+
+
+        /*
+        Function: beginBackfill
+        
+        Summary:
+        Start or resume writing a CSV log, like a file kept on an SD card while the network was down, to a ThingSpeak channel with serviceBackfill().
+        
+        Parameters:
+        job - backfillJob created earlier in the sketch, with channelNumber, writeAPIKey, updates, capacity and offset set.  offset is 0 for a new log, or the offset saved after the last successful serviceBackfill().
+        
+        Returns:
+        Always returns true
+        
+        Notes:
+        A bulk update is sent at most once every 15 seconds, the update limit of a free account.
+        */
+        bool beginBackfill(backfillJob & job)
+        {
+            return beginBackfill(job, GATEWAY_INTERVAL_MS);
+        }
+
+
+        /*
+        Function: serviceBackfill
+        
+        Summary:
+        Read the next rows of a CSV log and write them to the channel of the job with one bulk update, once the interval given to beginBackfill() has passed.
+        
+        Parameters:
+        job - backfillJob started with beginBackfill()
+        log - Stream the log is read from, like a File
+        
+        Returns:
+        200 - successful, job.offset was moved past the rows that were written.
+        -501 - No rows may be written now, or the whole log was written (see isBackfillDone())
+        See writeFields() for other possible return values.
+        
+        Notes:
+        Call it often from loop().  The rows of the next bulk update are read while waiting for the interval, and each call sends at most one request.
+        Each line of the log is one row: the created-at timestamp, in seconds since 1970-01-01 UTC or as "2024-03-01 12:34:56" (UTC, a trailing zone like "Z", "-05:00", "-0500" or "-05" is applied), then up to 8 field values, separated by commas.  Empty fields are left out.  Lines that don't start with a digit, like a header line, rows with a zone that cannot be read, and rows without a numeric field are skipped.
+        Rows that were not accepted are sent again with the next call.  To resume after a restart, save job.offset after every successful call, and pass it back to beginBackfill().
+        */
+        int serviceBackfill(backfillJob & job, Stream & log)
+        {
+            unsigned int batchSize = (job.capacity < BULK_UPDATES_MAX) ? job.capacity : BULK_UPDATES_MAX;
+            while(!job.ended && job.count < batchSize)
+            {
+                readBackfillRow(job, log);
+            }
+            
+            unsigned long now = millis();
+            if(0 == job.count || now - job.lastWriteAt < job.interval)
+            {
+                return TS_ERR_QUEUE_EMPTY;
+            }
+            
+            unsigned int numRows = job.count;
+            unsigned int start = 0;
+            int status = writeBulkUpdate(job.channelNumber, job.writeAPIKey, job.updates, job.capacity, start, job.count, true);
+            
+            if(resendOnNewConnection(status))
+            {
+                status = writeBulkUpdate(job.channelNumber, job.writeAPIKey, job.updates, job.capacity, start, job.count, true);
+            }
+            job.lastWriteAt = now;
+            if(status == TS_OK_SUCCESS)
+            {
+                job.rowsWritten += numRows;
+                job.offset = job.readOffset;
+                
+                #ifdef PRINT_DEBUG_MESSAGES
+                    Serial.print("ts::serviceBackfill (rows: "); Serial.print(job.rowsWritten); Serial.print(" offset: "); Serial.print(job.offset); Serial.print(" rows/s: "); Serial.print(getBackfillRate(job)); Serial.println(")");
+                #endif
+            }
+            return status;
+        }
+
+
+        /*
+        Function: isBackfillDone
+        
+        Summary:
+        Check whether all rows of the log were written.
+        
+        Parameters:
+        job - backfillJob started with beginBackfill()
+        
+        Returns:
+        true once the end of the log was read and all its rows were written
+        */
+        bool isBackfillDone(backfillJob & job)
+        {
+            return job.ended && 0 == job.count;
+        }
+
+
+        /*
+        Function: getBackfillRate
+        
+        Summary:
+        Get the rows written per second since beginBackfill() was called.
+        
+        Parameters:
+        job - backfillJob started with beginBackfill()
+        
+        Returns:
+        Rows per second
+        */
+        float getBackfillRate(backfillJob & job)
+        {
+            unsigned long elapsed = millis() - job.startedAt;
+            return (elapsed > 0) ? 1000.0 * job.rowsWritten / elapsed : 0.0;
+        }
+
+
+        /*
+        Function: executeTalkBackCommand
+        
+        Summary:
+        Fetch the next command of a TalkBack queue and mark it as executed.
+        
+        Parameters:
+        talkBackID - TalkBack ID
+        talkBackAPIKey - API key associated with the TalkBack.  *If you share code with others, do _not_ share this key*
+        
+        Returns:
+        Command string, or empty string if the TalkBack queue is empty or there is an error.  Use getLastReadStatus() to get more specific information.
+        
+        Notes:
+        This is one request to ThingSpeak for each command.  Use setTalkBack() and pollTalkBack() to fetch commands in the background.
+        */
+        String executeTalkBackCommand(unsigned long talkBackID, const char * talkBackAPIKey)
+        {
+            String command = String();
+            int status = requestTalkBackCommand(talkBackID, talkBackAPIKey, command);
+            
+            if(resendOnNewConnection(status))
+            {
+                status = requestTalkBackCommand(talkBackID, talkBackAPIKey, command);
+            }
+            
+            this->lastReadStatus = status;
+            if(status != TS_OK_SUCCESS)
+            {
+                return String("");
+            }
+            return command;
+        }
+
+
+        /*
+        Function: setTalkBack
+        
+        Summary:
+        Set the TalkBack that pollTalkBack() fetches commands from, and the local queue that keeps them until they are handled.
+        
+        Parameters:
+        talkBackID - TalkBack ID
+        talkBackAPIKey - API key associated with the TalkBack.  *If you share code with others, do _not_ share this key*
+        commands - Array of talkBackCommand created earlier in the sketch, used as the local command queue.
+        numCommands - Number of elements in commands.
+        
+        Returns:
+        Always returns true
+        
+        Notes:
+        Commands longer than 63 bytes are shortened to 63 bytes in the local queue.
+        */
+        bool setTalkBack(unsigned long talkBackID, const char * talkBackAPIKey, talkBackCommand * commands, unsigned int numCommands)
+        {
+            this->talkBackID = talkBackID;
+            this->talkBackAPIKey = talkBackAPIKey;
+            this->talkBackQueue = commands;
+            this->talkBackQueueSize = (NULL == commands) ? 0 : numCommands;
+            this->talkBackQueueStart = 0;
+            this->talkBackQueueCount = 0;
+            this->talkBackIntervalMS = this->talkBackMinIntervalMS;
+            this->talkBackPolled = false;
+            return true;
+        }
+
+
+        /*
+        Function: setTalkBackPollInterval
+        
+        Summary:
+        Set the range of the adaptive polling interval of pollTalkBack().
+        
+        Parameters:
+        minIntervalMS - Interval used right after a command was received.  Default is 1 second.
+        maxIntervalMS - Longest interval when no commands arrive.  Default is 60 seconds.
+        
+        Notes:
+        Every poll that finds no command doubles the interval up to maxIntervalMS, and a poll that finds a command sets it back to minIntervalMS.
+        This keeps the command latency low while commands are coming in, without wasting requests on an idle TalkBack.
+        */
+        void setTalkBackPollInterval(unsigned long minIntervalMS, unsigned long maxIntervalMS)
+        {
+            this->talkBackMinIntervalMS = minIntervalMS;
+            this->talkBackMaxIntervalMS = (maxIntervalMS < minIntervalMS) ? minIntervalMS : maxIntervalMS;
+            this->talkBackIntervalMS = minIntervalMS;
+        }
+
+
+        /*
+        Function: pollTalkBack
+        
+        Summary:
+        Fetch new TalkBack commands into the local command queue if the polling interval has passed.  Call this from loop().
+        
+        Returns:
+        200 - successful, or the polling interval has not passed yet.
+        -501 - setTalkBack() was not called before pollTalkBack()
+        See getLastReadStatus() for other possible return values.
+        
+        Notes:
+        Commands are fetched one after another over one kept-alive connection until the TalkBack is empty or the local queue is full.
+        Use getTalkBackCommand() to take the commands from the local queue.
+        */
+        int pollTalkBack()
+        {
+            if(0 == this->talkBackQueueSize)
+            {
+                return TS_ERR_QUEUE_EMPTY;
+            }
+            if(this->talkBackPolled && millis() - this->talkBackLastPoll < this->talkBackIntervalMS)
+            {
+                return TS_OK_SUCCESS;
+            }
+            if(this->talkBackQueueCount == this->talkBackQueueSize)
+            {
+                // no room, wait until the sketch has handled some commands
+                return TS_OK_SUCCESS;
+            }
+            
+            bool userKeepAlive = this->keepAlive;
+            this->keepAlive = true;
+            
+            int status = TS_OK_SUCCESS;
+            unsigned int received = 0;
+            while(this->talkBackQueueCount < this->talkBackQueueSize)
+            {
+                String command = executeTalkBackCommand(this->talkBackID, this->talkBackAPIKey);
+                status = getLastReadStatus();
+                if(status != TS_OK_SUCCESS || command.length() == 0)
+                {
+                    break;
+                }
+                command.toCharArray(this->talkBackQueue[(this->talkBackQueueStart + this->talkBackQueueCount) % this->talkBackQueueSize].command, TALKBACK_COMMAND_MAX);
+                this->talkBackQueueCount++;
+                received++;
+            }
+            
+            this->keepAlive = userKeepAlive;
+            if(!userKeepAlive)
+            {
+                this->client->stop();
+            }
+            
+            // back off while the TalkBack is idle or failing, tighten after activity
+            if(received > 0)
+            {
+                this->talkBackIntervalMS = this->talkBackMinIntervalMS;
+            }
+            else
+            {
+                this->talkBackIntervalMS = (this->talkBackIntervalMS > this->talkBackMaxIntervalMS / 2) ? this->talkBackMaxIntervalMS : this->talkBackIntervalMS * 2;
+            }
+            this->talkBackLastPoll = millis();
+            this->talkBackPolled = true;
+            
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::pollTalkBack (received: "); Serial.print(received); Serial.print(" next poll in ms: "); Serial.print(this->talkBackIntervalMS); Serial.println(")");
+            #endif
+            
+            return status;
+        }
+
+
+        /*
+        Function: getTalkBackCommand
+        
+        Summary:
+        Take the oldest command from the local TalkBack command queue.
+        
+        Returns:
+        Command string, or empty string if there is no command.
+        */
+        String getTalkBackCommand()
+        {
+            if(0 == this->talkBackQueueCount)
+            {
+                return String("");
+            }
+            String command = String(this->talkBackQueue[this->talkBackQueueStart].command);
+            this->talkBackQueueStart = (this->talkBackQueueStart + 1) % this->talkBackQueueSize;
+            this->talkBackQueueCount--;
+            return command;
+        }
+
+
+        /*
+        Function: getTalkBackCount
+        
+        Summary:
+        Get the number of commands waiting in the local TalkBack command queue.
+        
+        Returns:
+        Number of commands
+        */
+        unsigned int getTalkBackCount()
+        {
+            return this->talkBackQueueCount;
+        }
+
+
+        /*
+        Function: getTalkBackPollInterval
+        
+        Summary:
+        Get the current adaptive polling interval of pollTalkBack().
+        
+        Returns:
+        Interval in milliseconds
+        */
+        unsigned long getTalkBackPollInterval()
+        {
+            return this->talkBackIntervalMS;
+        }
+
+
+        /*
+        Function: readStringField
+        
+        Summary:
+        Read the latest string from a private ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        field - Field number (1-8) within the channel to read from.
+        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        
+        Returns:
+        Value read (UTF8 string), or empty string if there is an error.  Use getLastReadStatus() to get more specific information.
+        */
+        String readStringField(unsigned long channelNumber, unsigned int field, const char * readAPIKey)
+        {
+            if(field < FIELDNUM_MIN || field > FIELDNUM_MAX)
+            {
+                this->lastReadStatus = TS_ERR_INVALID_FIELD_NUM;
+                return("");
+            }
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::readStringField(channelNumber: "); Serial.print(channelNumber);
+                if(NULL != readAPIKey)
+                {
+                    Serial.print(" readAPIKey: "); Serial.print(readAPIKey);
+                }
+                Serial.print(" field: "); Serial.print(field); Serial.println(")");
+            #endif
+            String suffixURL = String("/fields/");
+            suffixURL.concat(field);
+            suffixURL.concat("/last");
+            
+            return readRaw(channelNumber, suffixURL, readAPIKey);
+        }
+
+
+        /*
+        Function: readStringField
+        
+        Summary:
+        Read the latest string from a public ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        field - Field number (1-8) within the channel to read from.
+        
+        Returns:
+        Value read (UTF8 string), or empty string if there is an error.  Use getLastReadStatus() to get more specific information.
+        */
+        String readStringField(unsigned long channelNumber, unsigned int field)
+        {
+            return readStringField(channelNumber, field, NULL);
+        }
+
+         
+        /*
+        Function: readFloatField
+        
+        Summary:
+        ead the latest floating point value from a private ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        field - Field number (1-8) within the channel to read from.
+        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        
+        Returns:
+        Value read, or 0 if the field is text or there is an error.  Use getLastReadStatus() to get more specific information.  Note that NAN, INFINITY, and -INFINITY are valid results.
+        */
+        float readFloatField(unsigned long channelNumber, unsigned int field, const char * readAPIKey)
+        {
+            return convertStringToFloat(readStringField(channelNumber, field, readAPIKey));
+        }
+
+        
+        /*
+        Function: readFloatField
+        
+        Summary:
+        Read the latest floating point value from a public ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        field - Field number (1-8) within the channel to read from.
+        
+        Returns:
+        Value read, or 0 if the field is text or there is an error.  Use getLastReadStatus() to get more specific information.  Note that NAN, INFINITY, and -INFINITY are valid results.
+        */
+        float readFloatField(unsigned long channelNumber, unsigned int field)
+        {
+            return readFloatField(channelNumber, field, NULL);
+        }
+
+         
+        /*
+        Function: readLongField
+        
+        Summary:
+        Read the latest long value from a private ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        field - Field number (1-8) within the channel to read from.
+        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        
+        Returns:
+        Value read, or 0 if the field is text or there is an error.  Use getLastReadStatus() to get more specific information.  Note that NAN, INFINITY, and -INFINITY are valid results.
+        */
+        long readLongField(unsigned long channelNumber, unsigned int field, const char * readAPIKey)
+        {
+            // Note that although the function is called "toInt" it really returns a long.
+            return readStringField(channelNumber, field, readAPIKey).toInt();
+        }
+
+         
+        /*
+        Function: readLongField
+        
+        Summary:
+        Read the latest long value from a public ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        field - Field number (1-8) within the channel to read from.
+        
+        Returns:
+        Value read, or 0 if the field is text or there is an error.  Use getLastReadStatus() to get more specific information.  Note that NAN, INFINITY, and -INFINITY are valid results.
+        */
+        long readLongField(unsigned long channelNumber, unsigned int field)
+        {
+            return readLongField(channelNumber, field, NULL);
+        }
+
+         
+        /*
+        Function: readIntField
+        
+        Summary:
+        Read the latest int value from a private ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        field - Field number (1-8) within the channel to read from.
+        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        
+        Returns:
+        Value read, or 0 if the field is text or there is an error.  Use getLastReadStatus() to get more specific information.  Note that NAN, INFINITY, and -INFINITY are valid results.
+        */
+        int readIntField(unsigned long channelNumber, unsigned int field, const char * readAPIKey)
+        {
+            return readLongField(channelNumber, field, readAPIKey);
+        }
+
+         
+        /*
+        Function: readIntField
+        
+        Summary:
+        Read the latest int value from a public ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        field - Field number (1-8) within the channel to read from.
+        
+        Returns:
+        Value read, or 0 if the field is text or there is an error.  Use getLastReadStatus() to get more specific information.  Note that NAN, INFINITY, and -INFINITY are valid results.
+        */
+        int readIntField(unsigned long channelNumber, unsigned int field)
+        {
+            return readLongField(channelNumber, field, NULL);
+        }
+
+
+        /*
+        Function: readStatus
+        
+        Summary:
+        Read the latest status from a private ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        
+        Results:
+        Value read (UTF8 string). An empty string is returned if there was no status written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
+        */
+        String readStatus(unsigned long channelNumber, const char * readAPIKey)
+        {
+            String content = readRaw(channelNumber, "/feeds/last.txt?status=true", readAPIKey);
+            
+            if(getLastReadStatus() != TS_OK_SUCCESS){
+                return String("");
+            }
+            
+            return getJSONValueByKey(content, "status");
+        }
+        
+         
+        /*
+        Function: readStatus
+        
+        Summary:
+        Read the latest status from a public ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        
+        Results:
+        Value read (UTF8 string). An empty string is returned if there was no status written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
+        */
+        String readStatus(unsigned long channelNumber)
+        {
+            return readStatus(channelNumber, NULL);
+        }
+        
+
+        /*
+        Function: readCreatedAt
+        
+        Summary:
+        Read the created-at timestamp associated with the latest update to a private ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        
+        Results:
+        Value read (UTF8 string). An empty string is returned if there was no created-at timestamp written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
+        */
+        String readCreatedAt(unsigned long channelNumber, const char * readAPIKey)
+        {
+            String content = readRaw(channelNumber, "/feeds/last.txt", readAPIKey);
+            
+            if(getLastReadStatus() != TS_OK_SUCCESS){
+                return String("");
+            }
+            
+            return getJSONValueByKey(content, "created_at");
+        }
+
+        
+        /*
+        Function: readCreatedAt
+        
+        Summary:
+        Read the created-at timestamp associated with the latest update to a public ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+            
+        Results:
+        Value read (UTF8 string). An empty string is returned if there was no created-at timestamp written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
+        */
+        String readCreatedAt(unsigned long channelNumber)
+        {
+            return readCreatedAt(channelNumber, NULL);
+        }
+
+
+        /*
+        Function: readLastEntryID
+        
+        Summary:
+        Read the entry ID of the latest update to a private ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        
+        Results:
+        Entry ID of the latest update, or 0 if the channel is empty or in case of an error.  Use getLastReadStatus() to get more specific information.
+        
+        Notes:
+        The last_entry_id of the channel is read from /channels/<id>/feeds.json?results=0, which has no updates, so it counts updates that leave out any field.  Compare the result with an earlier call to find out whether the channel was updated.
+        The request always goes to ThingSpeak, the read cache is not used.
+        */
+        long readLastEntryID(unsigned long channelNumber, const char * readAPIKey)
+        {
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::readLastEntryID (channelNumber: "); Serial.print(channelNumber); Serial.println(")");
+            #endif
+            
+            String readURL = String("/channels/");
+            readURL.concat(channelNumber);
+            readURL.concat("/feeds.json?results=0");
+            
+            int contentLength = 0;
+            long entryID = 0;
+            int status = requestRead(readURL, readAPIKey, contentLength);
+            if(status == TS_OK_SUCCESS)
+            {
+                beginBody(contentLength);
+                char value[12];
+                if(findInBody("\"last_entry_id\":") && readJSONValue(value, sizeof(value)))
+                {
+                    // null for a channel without updates
+                    entryID = strtol(value, NULL, 10);
+                }
+                else
+                {
+                    status = TS_ERR_BAD_RESPONSE;
+                }
+            }
+            this->lastReadStatus = status;
+            
+            emptyStream();
+            finishConnection((this->bodyRemaining > 0) ? TS_ERR_UNEXPECTED_FAIL : status);
+            
+            return (status == TS_OK_SUCCESS) ? entryID : 0;
+        }
+
+
+        /*
+        Function: readLastEntryID
+        
+        Summary:
+        Read the entry ID of the latest update to a public ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        
+        Results:
+        Entry ID of the latest update, or 0 if the channel is empty or in case of an error.  Use getLastReadStatus() to get more specific information.
+        */
+        long readLastEntryID(unsigned long channelNumber)
+        {
+            return readLastEntryID(channelNumber, NULL);
+        }
+           
+            
+        /*
+        Function: readChannelInfo
+        
+        Summary:
+        Read the name, field labels and enabled fields of a private ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        info - channelInfo record created earlier in the sketch that receives the description
+        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        
+        Returns:
+        HTTP status code of 200 if successful.
+        See getLastReadStatus() for other possible return values.
+        
+        Notes:
+        The description is parsed while it is received from /channels/<id>/feeds.json?results=0, so it is never held in memory as a whole.  Names and labels longer than the record holds are shortened.
+        info.version is set to CHANNELINFO_VERSION on success.  If the connection fails the record is left unchanged, a bad response leaves it invalid.
+        The record is plain data: save it to EEPROM or flash and pass it to setChannelInfo() after the next boot instead of reading it again.  Compare info.updatedAt with a fresh read to find out whether the channel settings changed.
+        */
+        int readChannelInfo(unsigned long channelNumber, channelInfo & info, const char * readAPIKey)
+        {
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::readChannelInfo (channelNumber: "); Serial.print(channelNumber); Serial.println(")");
+            #endif
+            
+            String readURL = String("/channels/");
+            readURL.concat(channelNumber);
+            readURL.concat("/feeds.json?results=0");
+            
+            int contentLength = 0;
+            int status = requestRead(readURL, readAPIKey, contentLength);
+            if(status == TS_OK_SUCCESS)
+            {
+                beginBody(contentLength);
+                status = parseChannelJSON(info);
+                if(status == TS_OK_SUCCESS && info.channelNumber == channelNumber)
+                {
+                    info.version = CHANNELINFO_VERSION;
+                }
+                else
+                {
+                    info.version = 0;
+                    status = TS_ERR_BAD_RESPONSE;
+                }
+            }
+            this->lastReadStatus = status;
+            
+            emptyStream();
+            finishConnection((this->bodyRemaining > 0) ? TS_ERR_UNEXPECTED_FAIL : status);
+            
+            return status;
+        }
+
+
+        /*
+        Function: readChannelInfo
+        
+        Summary:
+        Read the name, field labels and enabled fields of a public ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        info - channelInfo record created earlier in the sketch that receives the description
+        
+        Returns:
+        HTTP status code of 200 if successful.
+        See getLastReadStatus() for other possible return values.
+        */
+        int readChannelInfo(unsigned long channelNumber, channelInfo & info)
+        {
+            return readChannelInfo(channelNumber, info, NULL);
+        }
+
+
+        /*
+        Function: setChannelInfo
+        
+        Summary:
+        Set the channel description that setField() checks field numbers against.
+        
+        Parameters:
+        info - channelInfo record filled by readChannelInfo() or restored from EEPROM or flash, or NULL to stop checking.
+        
+        Returns:
+        true if setField() checks against the record, false if the record is NULL or not valid (for example never read, or saved by a different library version).
+        
+        Notes:
+        The record is used, not copied, so it must stay in scope.  It applies to every write, so use it in sketches that write to one channel.
+        */
+        bool setChannelInfo(channelInfo * info)
+        {
+            if(NULL != info && info->version != CHANNELINFO_VERSION)
+            {
+                info = NULL;
+            }
+            this->channelInfoRecord = info;
+            return NULL != info;
+        }
+
+
+        /*
+        Function: isFieldActive
+        
+        Summary:
+        Check whether a field is enabled in the channel description set with setChannelInfo().
+        
+        Parameters:
+        field - Field number (1-8)
+        
+        Returns:
+        true if the field is enabled, or if no channel description is set
+        */
+        bool isFieldActive(unsigned int field)
+        {
+            if(field < FIELDNUM_MIN || field > FIELDNUM_MAX) return false;
+            // a record that became invalid, for example through a failed readChannelInfo(), doesn't restrict anything
+            if(NULL == this->channelInfoRecord || this->channelInfoRecord->version != CHANNELINFO_VERSION) return true;
+            return 0 != (this->channelInfoRecord->activeFields & (1 << (field - 1)));
+        }
+
+
+        /*
+        Function: readRaw
+        
+        Summary:
+        Read a raw response from a private ThingSpeak channel
+        
+        Parameters:
+        channelNumber - Channel number
+        suffixURL - Raw URL to write to ThingSpeak as a String.  See the documentation at https://thingspeak.com/docs/channels#get_feed
+        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        
+        Returns:
+        Response if successful, or empty string. Use getLastReadStatus() to get more specific information.
+        
+        Notes:
+        This is low level functionality that will not be required by most users.
+        */
+        String readRaw(unsigned long channelNumber, String suffixURL, const char * readAPIKey)
+        {
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::readRaw   (channelNumber: "); Serial.print(channelNumber);
+                if(NULL != readAPIKey)
+                {
+                    Serial.print(" readAPIKey: "); Serial.print(readAPIKey);
+                }
+                Serial.print(" suffixURL: \""); Serial.print(suffixURL); Serial.println("\")");
+            #endif
+
+            readCacheEntry * cached = findReadCacheEntry(channelNumber, suffixURL, readAPIKey);
+            if(NULL != cached)
+            {
+                #ifdef PRINT_DEBUG_MESSAGES
+                    Serial.print("               Cached: \""); Serial.print(cached->value); Serial.println("\"");
+                #endif
+                this->readCacheHits++;
+                this->lastReadStatus = TS_OK_SUCCESS;
+                return String(cached->value);
+            }
+            if(NULL != this->readCache)
+            {
+                this->readCacheMisses++;
+            }
+
+            String readURL = String("/channels/");
+            readURL.concat(channelNumber);
+            readURL.concat(suffixURL);
+            
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("               GET \"");Serial.print(readURL);Serial.println("\"");
+            #endif
+
+            // Get data from thingspeak
+            int contentLength = 0;
+            String content = String();
+            int status = requestRead(readURL, readAPIKey, contentLength);
+            if(status == TS_OK_SUCCESS)
+            {
+                status = getHTTPResponseBody(content, contentLength);
+            }
+                
+            this->lastReadStatus = status;
+            
+            emptyStream();
+            
+            #ifdef PRINT_DEBUG_MESSAGES
+                if(status == TS_OK_SUCCESS)
+                {
+                    Serial.print("Read: \""); Serial.print(content); Serial.println("\"");
+                }
+            #endif
+                    
+            finishConnection(status);
+
+            if(status != TS_OK_SUCCESS)
+            {
+                return String("");
+            }
+
+            storeReadCacheEntry(channelNumber, suffixURL, readAPIKey, content);
+
+            return content;
+        }
+        
+        
+        /*
+        Function: readRaw
+           
+        Summary:
+        Read a raw response from a public ThingSpeak channel
+           
+        Parameters:
+        channelNumber - Channel number
+        suffixURL - Raw URL to write to ThingSpeak as a String.  See the documentation at https://thingspeak.com/docs/channels#get_feed
+           
+        Returns:
+        Response if successful, or empty string. Use getLastReadStatus() to get more specific information.
+           
+        Notes:
+        This is low level functionality that will not be required by most users.
+        */
+        String readRaw(unsigned long channelNumber, String suffixURL)
+        {
+            return readRaw(channelNumber, suffixURL, NULL);
+        }
+
+
+        /*
+        Function: setReadCache
+        
+        Summary:
+        Enable the read cache, so that repeated reads of the same channel, field and API key within the time-to-live are answered locally instead of over HTTP.
+        
+        Parameters:
+        entries - Array of readCacheEntry created earlier in the sketch.  The array is used as the cache storage, so it must stay valid while the cache is enabled.
+        numEntries - Number of elements in entries.  When the cache is full the oldest entry is replaced.
+        ttlMS - Time-to-live of a cached value in milliseconds.
+        
+        Returns:
+        Always returns true
+        
+        Notes:
+        Only successful responses of up to 63 bytes are cached, which covers the readStringField(), readFloatField(), readLongField() and readIntField() families.
+        A write to a channel drops the cached values of that channel.  Pass NULL as entries to disable the cache.
+        */
+        bool setReadCache(readCacheEntry * entries, unsigned int numEntries, unsigned long ttlMS)
+        {
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::setReadCache(numEntries: "); Serial.print(numEntries); Serial.print(" ttlMS: "); Serial.print(ttlMS); Serial.println(")");
+            #endif
+            this->readCache = entries;
+            this->readCacheSize = (NULL == entries) ? 0 : numEntries;
+            this->readCacheTTL = ttlMS;
+            clearReadCache();
+            return true;
+        }
+
+
+        /*
+        Function: clearReadCache
+        
+        Summary:
+        Drop every cached value and reset the hit and miss counters.
+        */
+        void clearReadCache()
+        {
+            for(unsigned int i = 0; i < this->readCacheSize; i++)
+            {
+                this->readCache[i].valid = false;
+            }
+            this->readCacheHits = 0;
+            this->readCacheMisses = 0;
+        }
+
+
+        /*
+        Function: getReadCacheHits
+        
+        Summary:
+        Get the number of reads that were answered from the read cache since it was enabled or cleared.
+        
+        Returns:
+        Number of cache hits
+        */
+        unsigned long getReadCacheHits()
+        {
+            return this->readCacheHits;
+        }
+
+
+        /*
+        Function: getReadCacheMisses
+        
+        Summary:
+        Get the number of reads that had to go to ThingSpeak since the read cache was enabled or cleared.
+        
+        Returns:
+        Number of cache misses
+        */
+        unsigned long getReadCacheMisses()
+        {
+            return this->readCacheMisses;
+        }
+
+
+
+        /*
+        Function: readFeedColumns
+        
+        Summary:
+        Read the latest updates of a private ThingSpeak channel straight into arrays, one array per field.
+        
+        Parameters:
+        channelNumber - Channel number
+        results - Number of updates to read, at most columns.capacity.
+        columns - feedColumns with the arrays to fill.  Set the arrays of the fields that are not needed to NULL.
+        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        
+        Returns:
+        HTTP status code of 200 if successful.
+        
+        Notes:
+        The response is parsed while it is received, so neither the response nor the values are stored as Strings.
+        Updates are stored oldest first and columns.count is set to the number of updates stored.  Missing and non-numeric values are stored as NAN.
+        See getLastReadStatus() for other possible return values.
+        */
+        int readFeedColumns(unsigned long channelNumber, unsigned int results, feedColumns & columns, const char * readAPIKey)
+        {
+            if(results > columns.capacity)
+            {
+                results = columns.capacity;
+            }
+            String suffixURL = String((this->feedFormat == TS_FEED_FORMAT_CSV) ? "/feeds.csv?results=" : "/feeds.json?results=");
+            suffixURL.concat(results);
+            
+            return readFeed(channelNumber, suffixURL, columns, readAPIKey);
+        }
+
+
+        /*
+        Function: readFeedColumns
+        
+        Summary:
+        Read the latest updates of a public ThingSpeak channel straight into arrays, one array per field.
+        
+        Parameters:
+        channelNumber - Channel number
+        results - Number of updates to read, at most columns.capacity.
+        columns - feedColumns with the arrays to fill.  Set the arrays of the fields that are not needed to NULL.
+        
+        Returns:
+        HTTP status code of 200 if successful.
+        
+        Notes:
+        See getLastReadStatus() for other possible return values.
+        */
+        int readFeedColumns(unsigned long channelNumber, unsigned int results, feedColumns & columns)
+        {
+            return readFeedColumns(channelNumber, results, columns, NULL);
+        }
+
+
+        /*
+        Function: syncChannelMirror
+        
+        Summary:
+        Bring a local copy of a ThingSpeak channel up to date, reading only the entries newer than the ones already copied.
+        
+        Parameters:
+        channelNumber - Channel number
+        mirror - Sync state of the copy.  A mirror that is new, or was kept for another channel, starts the copy from the first entry of the channel.
+        page - feedColumns the entries are read into, entryID and createdAt must be set.  capacity is the number of entries read per request.
+        store - Where the new entries are appended, like a file on an SD card, one line per entry: entry ID, created-at timestamp in seconds since 1970-01-01 UTC and the 8 fields, separated by commas, with empty fields for missing or non-numeric values.
+        readAPIKey - Read API key associated with the channel.  *If you share code with others, do _not_ share this key*
+        
+        Returns:
+        HTTP status code of 200 if successful, -101 if page has no entryID or createdAt array, or if more entries were written within two seconds than page.capacity.
+        
+        Notes:
+        Each call makes one request, call it until isChannelMirrorSynced() returns true.  getMirrorAppended() tells how many entries the call appended.
+        The entries are read in time windows that grow and shrink with the number of entries in them, so that no window holds more than a page.
+        The mirror is only changed after the entries are appended, so the copy can be resumed after an interruption: flush the store, then save the mirror, after every call.
+        */
+        int syncChannelMirror(unsigned long channelNumber, channelMirror & mirror, feedColumns & page, Print & store, const char * readAPIKey)
+        {
+            this->mirrorAppended = 0;
+            if(NULL == page.entryID || NULL == page.createdAt || 0 == page.capacity)
+            {
+                this->lastReadStatus = TS_ERR_OUT_OF_RANGE;
+                return this->lastReadStatus;
+            }
+            if(mirror.version != CHANNELMIRROR_VERSION || mirror.channelNumber != channelNumber)
+            {
+                memset(&mirror, 0, sizeof(mirror));
+                mirror.version = CHANNELMIRROR_VERSION;
+                mirror.channelNumber = channelNumber;
+                mirror.channelLastEntryID = 0xFFFFFFFFUL; // not known before the first read
+            }
+            
+            String suffixURL = String("/feeds.json?results=");
+            suffixURL.concat(page.capacity);
+            if(mirror.syncedTo > 0 || mirror.span > 0)
+            {
+                suffixURL.concat("&timezone=UTC&start=");
+                appendTimestamp(suffixURL, mirror.syncedTo);
+                if(mirror.span > 0)
+                {
+                    suffixURL.concat("&end=");
+                    appendTimestamp(suffixURL, mirror.syncedTo + mirror.span);
+                }
+            }
+            
+            channelInfo info;
+            int status = readFeed(channelNumber, suffixURL, page, readAPIKey, &info);
+            if(status != TS_OK_SUCCESS)
+            {
+                return status;
+            }
+            mirror.channelLastEntryID = info.lastEntryID;
+            
+            bool full = (page.count >= page.capacity);
+            if(full && page.entryID[0] > mirror.lastEntryID + 1)
+            {
+                // only the newest entries of the window came back; the missing ones are not newer than the oldest that came back,
+                // so the next window ends there, and is halved unless a page holds the entry IDs in between (some may have been deleted)
+                uint32_t limit = (page.createdAt[0] > mirror.syncedTo) ? page.createdAt[0] - mirror.syncedTo : 0;
+                uint32_t span = (mirror.span == 0 || mirror.span > limit) ? limit : mirror.span;
+                if(span == mirror.span || page.entryID[0] - mirror.lastEntryID >= page.capacity)
+                {
+                    span /= 2;
+                }
+                if(0 == span)
+                {
+                    // more entries share a second than a page holds, going on would leave them out of the copy
+                    this->lastReadStatus = TS_ERR_OUT_OF_RANGE;
+                    return this->lastReadStatus;
+                }
+                mirror.span = span;
+                return TS_OK_SUCCESS;
+            }
+            
+            for(unsigned int i = 0; i < page.count; i++)
+            {
+                if(page.entryID[i] <= mirror.lastEntryID)
+                {
+                    continue;
+                }
+                printMirrorEntry(store, page, i);
+                mirror.lastEntryID = page.entryID[i];
+                mirror.lastCreatedAt = page.createdAt[i];
+                this->mirrorAppended++;
+            }
+            
+            if(full)
+            {
+                // go on from the newest entry, the window may hold more
+                mirror.syncedTo = (this->mirrorAppended > 0) ? mirror.lastCreatedAt : mirror.syncedTo + 1;
+            }
+            else if(mirror.lastEntryID >= mirror.channelLastEntryID || mirror.span == 0)
+            {
+                // caught up, the next sync reads whatever came after the newest entry
+                mirror.syncedTo = mirror.lastCreatedAt;
+                mirror.span = 0;
+                mirror.channelLastEntryID = mirror.lastEntryID;
+            }
+            else
+            {
+                // the window is done and lies in the past, since the channel has newer entries
+                mirror.syncedTo += mirror.span;
+                if(page.count < page.capacity / 2 && mirror.span < 0x40000000UL)
+                {
+                    mirror.span *= 2;
+                }
+            }
+            return TS_OK_SUCCESS;
+        }
+
+
+        /*
+        Function: syncChannelMirror
+        
+        Summary:
+        Bring a local copy of a public ThingSpeak channel up to date, reading only the entries newer than the ones already copied.
+        
+        Parameters:
+        channelNumber - Channel number
+        mirror - Sync state of the copy.  A mirror that is new, or was kept for another channel, starts the copy from the first entry of the channel.
+        page - feedColumns the entries are read into, entryID and createdAt must be set.  capacity is the number of entries read per request.
+        store - Where the new entries are appended, see the other overload for the format.
+        
+        Returns:
+        HTTP status code of 200 if successful, -101 if page has no entryID or createdAt array, or if more entries were written within two seconds than page.capacity.
+        
+        Notes:
+        Each call makes one request, call it until isChannelMirrorSynced() returns true.
+        */
+        int syncChannelMirror(unsigned long channelNumber, channelMirror & mirror, feedColumns & page, Print & store)
+        {
+            return syncChannelMirror(channelNumber, mirror, page, store, NULL);
+        }
+
+
+        /*
+        Function: isChannelMirrorSynced
+        
+        Summary:
+        Check whether a local copy had all entries of its channel at the last syncChannelMirror().
+        
+        Parameters:
+        mirror - Sync state of the copy
+        
+        Returns:
+        true if the copy was up to date at the last sync
+        */
+        bool isChannelMirrorSynced(channelMirror & mirror)
+        {
+            return mirror.version == CHANNELMIRROR_VERSION && mirror.lastEntryID >= mirror.channelLastEntryID;
+        }
+
+
+        /*
+        Function: getMirrorAppended
+        
+        Summary:
+        Get the number of entries the last syncChannelMirror() appended to the copy.
+        
+        Returns:
+        Number of appended entries
+        */
+        unsigned int getMirrorAppended()
+        {
+            return this->mirrorAppended;
+        }
+
+
+
+        /*
+        Function: setFeedFormat
+        
+        Summary:
+        Select the format in which readFeedColumns() requests updates from ThingSpeak.
+        
+        Parameters:
+        format - TS_FEED_FORMAT_JSON (default) or TS_FEED_FORMAT_CSV.
+        
+        Returns:
+        Code of 200 if successful.
+        Code of -101 if the format is unknown.
+        
+        Notes:
+        CSV does not repeat the key names in every update, so the response is about half the size of JSON and faster to parse.  The columns are mapped once from the header line.
+        */
+        int setFeedFormat(int format)
+        {
+            if(format != TS_FEED_FORMAT_JSON && format != TS_FEED_FORMAT_CSV) return TS_ERR_OUT_OF_RANGE;
+            this->feedFormat = format;
+            
+            return TS_OK_SUCCESS;
+        }
+
+
+        /*
+        Function: setFieldSeries
+        
+        Summary:
+        Keep a local history of a field in a fixed-size ring of samples.
+        
+        Parameters:
+        field - Field number (1-8) to keep the history of.
+        series - timeSeries with the time and value arrays created earlier in the sketch, or NULL to stop keeping the history.
+        
+        Returns:
+        Code of 200 if successful.
+        Code of -201 if the field number is invalid.
+        
+        Notes:
+        Every numeric value passed to setField() or writeField() for the field is recorded with the time of setSeriesClock().  When the ring is full the oldest sample is replaced.
+        Use backfillSeries() to fill the history from readFeedColumns(), for example after a restart.
+        */
+        int setFieldSeries(unsigned int field, timeSeries * series)
+        {
+            if(field < FIELDNUM_MIN || field > FIELDNUM_MAX) return TS_ERR_INVALID_FIELD_NUM;
+            
+            if(NULL != series)
+            {
+                series->start = 0;
+                series->count = 0;
+            }
+            this->fieldSeries[field - 1] = series;
+            
+            return TS_OK_SUCCESS;
+        }
+
+
+        /*
+        Function: setSeriesClock
+        
+        Summary:
+        Set the clock used to timestamp the samples recorded by setFieldSeries().
+        
+        Parameters:
+        clock - Function returning the current time in seconds, or NULL to use the seconds since the board started.
+        
+        Notes:
+        Use a clock that returns seconds since 1970-01-01 UTC (for example from NTP) if the history is mixed with samples from backfillSeries().
+        */
+        void setSeriesClock(uint32_t (*clock)())
+        {
+            this->seriesClock = clock;
+        }
+
+
+        /*
+        Function: backfillSeries
+        
+        Summary:
+        Add updates read by readFeedColumns() to the local histories of the fields.
+        
+        Parameters:
+        columns - feedColumns filled by readFeedColumns(), with the createdAt array set.
+        
+        Returns:
+        Number of samples added over all fields.
+        
+        Notes:
+        Only updates newer than the latest sample of a history are added, so the same columns can be applied more than once.
+        */
+        unsigned int backfillSeries(feedColumns & columns)
+        {
+            unsigned int added = 0;
+            if(NULL == columns.createdAt)
+            {
+                return 0;
+            }
+            for(size_t iField = 0; iField < FIELDNUM_MAX; iField++)
+            {
+                if(NULL == this->fieldSeries[iField] || NULL == columns.field[iField])
+                {
+                    continue;
+                }
+                for(unsigned int row = 0; row < columns.count; row++)
+                {
+                    if(!isnan(columns.field[iField][row]) && appendSeriesSample(this->fieldSeries[iField], columns.createdAt[row], columns.field[iField][row], false))
+                    {
+                        added++;
+                    }
+                }
+            }
+            return added;
+        }
+
+
+        /*
+        Function: getSeriesRange
+        
+        Summary:
+        Copy the samples of a field history taken between two times.
+        
+        Parameters:
+        field - Field number (1-8) with a history set by setFieldSeries().
+        fromTime - Earliest time to copy, in seconds.
+        toTime - Latest time to copy, in seconds.
+        times - Array receiving the sample times, or NULL.
+        values - Array receiving the sample values.
+        maxCount - Number of elements in times and values.
+        
+        Returns:
+        Number of samples copied, oldest first.
+        
+        Notes:
+        The first sample is found with a binary search, so the cost does not depend on the size of the history.
+        */
+        unsigned int getSeriesRange(unsigned int field, uint32_t fromTime, uint32_t toTime, uint32_t * times, float * values, unsigned int maxCount)
+        {
+            timeSeries * series = getFieldSeries(field);
+            if(NULL == series)
+            {
+                return 0;
+            }
+            
+            unsigned int copied = 0;
+            for(unsigned int i = findSeriesIndex(series, fromTime); i < series->count && copied < maxCount; i++)
+            {
+                unsigned int slot = (series->start + i) % series->capacity;
+                if(series->time[slot] > toTime)
+                {
+                    break;
+                }
+                if(NULL != times) times[copied] = series->time[slot];
+                values[copied] = series->value[slot];
+                copied++;
+            }
+            return copied;
+        }
+
+
+        /*
+        Function: getSeriesLatest
+        
+        Summary:
+        Copy the latest samples of a field history.
+        
+        Parameters:
+        field - Field number (1-8) with a history set by setFieldSeries().
+        times - Array receiving the sample times, or NULL.
+        values - Array receiving the sample values.
+        maxCount - Number of samples to copy.
+        
+        Returns:
+        Number of samples copied, oldest first.
+        */
+        unsigned int getSeriesLatest(unsigned int field, uint32_t * times, float * values, unsigned int maxCount)
+        {
+            timeSeries * series = getFieldSeries(field);
+            if(NULL == series)
+            {
+                return 0;
+            }
+            
+            unsigned int first = (series->count > maxCount) ? series->count - maxCount : 0;
+            unsigned int copied = 0;
+            for(unsigned int i = first; i < series->count; i++)
+            {
+                unsigned int slot = (series->start + i) % series->capacity;
+                if(NULL != times) times[copied] = series->time[slot];
+                values[copied] = series->value[slot];
+                copied++;
+            }
+            return copied;
+        }
+
+
+        /*
+        Function: getSeriesDownsampled
+        
+        Summary:
+        Average the samples of a field history between two times into intervals of equal length.
+        
+        Parameters:
+        field - Field number (1-8) with a history set by setFieldSeries().
+        fromTime - Start of the first interval, in seconds.
+        toTime - Latest time to include, in seconds.
+        intervalSeconds - Length of each interval, for example 60 for one value per minute.
+        times - Array receiving the start time of each interval, or NULL.
+        values - Array receiving the mean of each interval.
+        maxCount - Number of elements in times and values.
+        
+        Returns:
+        Number of intervals copied, oldest first.  Intervals without samples are left out.
+        */
+        unsigned int getSeriesDownsampled(unsigned int field, uint32_t fromTime, uint32_t toTime, uint32_t intervalSeconds, uint32_t * times, float * values, unsigned int maxCount)
+        {
+            timeSeries * series = getFieldSeries(field);
+            if(NULL == series || 0 == intervalSeconds || 0 == maxCount)
+            {
+                return 0;
+            }
+            
+            unsigned int copied = 0;
+            uint32_t intervalStart = 0;
+            float sum = 0;
+            unsigned int samples = 0;
+            for(unsigned int i = findSeriesIndex(series, fromTime); i < series->count; i++)
+            {
+                unsigned int slot = (series->start + i) % series->capacity;
+                uint32_t sampleTime = series->time[slot];
+                if(sampleTime > toTime)
+                {
+                    break;
+                }
+                uint32_t sampleInterval = fromTime + ((sampleTime - fromTime) / intervalSeconds) * intervalSeconds;
+                if(samples > 0 && sampleInterval != intervalStart)
+                {
+                    if(NULL != times) times[copied] = intervalStart;
+                    values[copied] = sum / samples;
+                    if(++copied >= maxCount)
+                    {
+                        return copied;
+                    }
+                    samples = 0;
+                    sum = 0;
+                }
+                intervalStart = sampleInterval;
+                sum += series->value[slot];
+                samples++;
+            }
+            if(samples > 0)
+            {
+                if(NULL != times) times[copied] = intervalStart;
+                values[copied] = sum / samples;
+                copied++;
+            }
+            return copied;
+        }
+        
+        
+        #ifndef ARDUINO_AVR_UNO // Arduino Uno doesn't have enough memory to perform the following functionalities.
+            
+            /*
+            Function: readMultipleFields
+             
+            Summary:
+            Read all the field values, status message, location coordinates, and created-at timestamp associated with the latest feed to a private ThingSpeak channel and store the values locally in variables within a struct.
+             
+            Parameters:
+            channelNumber - Channel number
+            readAPIKey - Read API key associated with the channel. *If you share code with others, do _not_ share this key*
+             
+            Returns:
+            HTTP status code of 200 if successful.
+            
+            Notes:
+            See getLastReadStatus() for other possible return values.
+            */
+            int readMultipleFields(unsigned long channelNumber, const char * readAPIKey)
             {
                 String readCondition = "/feeds/last.txt?status=true&location=true";
                 
-                String multiContent = readRaw(channelNumber, readCondition, readAPIKey);
+                String multiContent = readRaw(channelNumber, readCondition, readAPIKey);
+                
+                if(getLastReadStatus() != TS_OK_SUCCESS){
+                    return getLastReadStatus();
+                }
+                
+                this->lastFeed.nextReadField[0] = parseValues(multiContent, "field1");
+                this->lastFeed.nextReadField[1] = parseValues(multiContent, "field2");
+                this->lastFeed.nextReadField[2] = parseValues(multiContent, "field3");
+                this->lastFeed.nextReadField[3] = parseValues(multiContent, "field4");
+                this->lastFeed.nextReadField[4] = parseValues(multiContent, "field5");
+                this->lastFeed.nextReadField[5] = parseValues(multiContent, "field6");
+                this->lastFeed.nextReadField[6] = parseValues(multiContent, "field7");
+                this->lastFeed.nextReadField[7] = parseValues(multiContent, "field8");
+                this->lastFeed.nextReadCreatedAt = parseValues(multiContent, "created_at");
+                this->lastFeed.nextReadLatitude = parseValues(multiContent, "latitude");
+                this->lastFeed.nextReadLongitude = parseValues(multiContent, "longitude");
+                this->lastFeed.nextReadElevation = parseValues(multiContent, "elevation");
+                this->lastFeed.nextReadStatus = parseValues(multiContent, "status");
+                this->lastFeedChannelNumber = channelNumber;
+                this->lastFeedEntryID = getJSONNumberByKey(multiContent, "entry_id");
+                
+                return TS_OK_SUCCESS;
+            }
+            
+            
+            /*
+            Function: readMultipleFields
+            
+            Summary:
+            Read all the field values, status message, location coordinates, and created-at timestamp associated with the latest update to a private ThingSpeak channel and store the values locally in variables within a struct.
+             
+            Parameters:
+            channelNumber - Channel number
+            readAPIKey - Read API key associated with the channel. *If you share code with others, do _not_ share this key*
+             
+            Returns:
+            HTTP status code of 200 if successful.
+            
+            Notes:
+            See getLastReadStatus() for other possible return values.
+            */
+            int readMultipleFields(unsigned long channelNumber)
+            {
+                return readMultipleFields(channelNumber, NULL);
+            }
+
+            
+            /*
+            Function: readMultipleFieldsIfChanged
+             
+            Summary:
+            Read all the field values, status message, location coordinates, and created-at timestamp of a private ThingSpeak channel, but only if the channel was updated since the last readMultipleFields().
+             
+            Parameters:
+            channelNumber - Channel number
+            readAPIKey - Read API key associated with the channel. *If you share code with others, do _not_ share this key*
+             
+            Returns:
+            200 - a new entry was read and stored.
+            304 - there is no new entry, the stored values are unchanged.
+            
+            Notes:
+            The check uses readLastEntryID(), which transfers a fraction of the full update. See getLastReadStatus() for other possible return values.
+            */
+            int readMultipleFieldsIfChanged(unsigned long channelNumber, const char * readAPIKey)
+            {
+                long entryID = readLastEntryID(channelNumber, readAPIKey);
+                
+                if(getLastReadStatus() != TS_OK_SUCCESS){
+                    return getLastReadStatus();
+                }
+                
+                if(channelNumber == this->lastFeedChannelNumber && entryID == this->lastFeedEntryID){
+                    #ifdef PRINT_DEBUG_MESSAGES
+                        Serial.print("ts::readMultipleFieldsIfChanged (entry ID "); Serial.print(entryID); Serial.println(" unchanged)");
+                    #endif
+                    return TS_OK_NOT_MODIFIED;
+                }
+                
+                return readMultipleFields(channelNumber, readAPIKey);
+            }
+            
+            
+            /*
+            Function: readMultipleFieldsIfChanged
+             
+            Summary:
+            Read all the field values, status message, location coordinates, and created-at timestamp of a public ThingSpeak channel, but only if the channel was updated since the last readMultipleFields().
+             
+            Parameters:
+            channelNumber - Channel number
+             
+            Returns:
+            200 - a new entry was read and stored.
+            304 - there is no new entry, the stored values are unchanged.
+            
+            Notes:
+            See getLastReadStatus() for other possible return values.
+            */
+            int readMultipleFieldsIfChanged(unsigned long channelNumber)
+            {
+                return readMultipleFieldsIfChanged(channelNumber, NULL);
+            }
+            
+            
+            /*
+            Function: getFieldAsString
+             
+            Summary:
+            Fetch the value as string from the latest stored feed record.
+            
+            Parameters:
+            field - Field number (1-8) within the channel to read from.
+            
+            Returns:
+            Value read (UTF8 string), empty string if there is an error, or old value read (UTF8 string) if invoked before readMultipleFields().  Use getLastReadStatus() to get more specific information.
+            */
+            String getFieldAsString(unsigned int field)
+            {
+                if(field < FIELDNUM_MIN || field > FIELDNUM_MAX)
+                {
+                    this->lastReadStatus = TS_ERR_INVALID_FIELD_NUM;
+                    return("");
+                }
+                
+                this->lastReadStatus = TS_OK_SUCCESS;
+                return this->lastFeed.nextReadField[field-1];
+            }
+            
+            
+            /*
+            Function: getFieldAsFloat
+             
+            Summary:
+            Fetch the value as float from the latest stored feed record.
+            
+            Parameters:
+            field - Field number (1-8) within the channel to read from.
+            
+            Returns:
+            Value read, 0 if the field is text or there is an error, or old value read if invoked before readMultipleFields(). Use getLastReadStatus() to get more specific information.  Note that NAN, INFINITY, and -INFINITY are valid results.
+            */
+            float getFieldAsFloat(unsigned int field)
+            {
+                return convertStringToFloat(getFieldAsString(field));
+            }
+            
+            
+            /*
+            Function: getFieldAsLong
+            
+            Summary:
+            Fetch the value as long from the latest stored feed record.
+            
+            Parameters:
+            field - Field number (1-8) within the channel to read from.
+            
+            Returns:
+            Value read, 0 if the field is text or there is an error, or old value read if invoked before readMultipleFields(). Use getLastReadStatus() to get more specific information.
+            */
+            long getFieldAsLong(unsigned int field)
+            {
+                // Note that although the function is called "toInt" it really returns a long.
+                return getFieldAsString(field).toInt();
+            }
+            
+            
+            /*
+            Function: getFieldAsInt
+             
+            Summary:
+            Fetch the value as int from the latest stored feed record.
+            
+            Parameters:
+            field - Field number (1-8) within the channel to read from.
+            
+            Returns:
+            Value read, 0 if the field is text or there is an error, or old value read if invoked before readMultipleFields(). Use getLastReadStatus() to get more specific information.
+            */
+            int getFieldAsInt(unsigned int field)
+            {
+                // int and long are same
+                return getFieldAsLong(field);
+            }
+            
+                
+            /*
+            Function: getStatus
+             
+            Summary:
+            Fetch the status message associated with the latest stored feed record.
+            
+            Results:
+            Value read (UTF8 string). An empty string is returned if there was no status written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
+            */
+            String getStatus()
+            {
+                return this->lastFeed.nextReadStatus;
+            }
+            
+            
+            /*
+            Function: getLatitude
+             
+            Summary:
+            Fetch the latitude associated with the latest stored feed record.
+            
+            Results:
+            Value read (UTF8 string). An empty string is returned if there was no latitude written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
+            */
+            String getLatitude()
+            {
+                return this->lastFeed.nextReadLatitude;
+            }
+            
+            
+            /*
+            Function: getLongitude
+             
+            Summary:
+            Fetch the longitude associated with the latest stored feed record.
+            
+            Results:
+            Value read (UTF8 string). An empty string is returned if there was no longitude written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
+            */
+            String getLongitude()
+            {
+                return this->lastFeed.nextReadLongitude;
+            }
+            
+            
+            /*
+            Function: getElevation
+             
+            Summary:
+            Fetch the longitude associated with the latest stored feed record.
+            
+            Results:
+            Value read (UTF8 string). An empty string is returned if there was no elevation written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
+            */
+            String getElevation()
+            {
+                return this->lastFeed.nextReadElevation;
+            }
+            
+            
+            /*
+            Function: getCreatedAt
+             
+            Summary:
+            Fetch the created-at timestamp associated with the latest stored feed record.
+            
+            Results:
+            Value read (UTF8 string). An empty string is returned if there was no created-at timestamp written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
+            */
+            String getCreatedAt()
+            {
+                return this->lastFeed.nextReadCreatedAt;
+            }
+
+            
+            
+            /*
+            Function: getEntryID
+             
+            Summary:
+            Fetch the entry ID of the latest stored feed record.
+            
+            Results:
+            Entry ID, or 0 if readMultipleFields() was not called or the response did not contain an entry ID.
+            */
+            long getEntryID()
+            {
+                return this->lastFeedEntryID;
+            }
+        
+        #endif
+        
+     
+        /*
+        Function: getLastReadStatus
+        
+        Summary:
+        Get the status of the previous read.
+        
+        Returns:
+        Generally, these are HTTP status codes.  Negative values indicate an error generated by the library.
+        Possible response codes...
+        200 - OK / Success
+        404 - Incorrect API key (or invalid ThingSpeak server address)
+        -101 - Value is out of range or string is too long (> 255 characters)
+        -201 - Invalid field number specified
+        -210 - setField() was not called before writeFields()
+        -301 - Failed to connect to ThingSpeak
+        -302 -  Unexpected failure during write to ThingSpeak
+        -303 - Unable to parse response
+        -304 - Timeout waiting for server to respond
+        -401 - Point was not inserted (most probable cause is exceeding the rate limit)
+        
+        Notes:
+        The read functions will return zero or empty if there is an error.  Use this function to retrieve the details.
+        */
+        int getLastReadStatus()
+        {
+            return this->lastReadStatus;
+        }
+        
+        
+    private:
+            
+        // sends the body of an update request, for writeRaw()
+        int postUpdate(const char * writeAPIKey, String & postMessage)
+        {
+            if(!connectThingSpeak())
+            {
+                // Failed to connect to ThingSpeak
+                return TS_ERR_CONNECT_FAILED;
+            }
+            
+            // Post data to thingspeak
+            if(!writeUpdateHeader(writeAPIKey, postMessage.length())) return abortRequest();
+            if(!this->client->print(postMessage)) return abortRequest();
+            
+            return finishWrite();
+        }
+        
+        // sends the urgent update, which stays waiting until ThingSpeak accepted it
+        int writeUrgentUpdate(unsigned long channelNumber, const char * writeAPIKey)
+        {
+            invalidateReadCache(channelNumber);
+            
+            if(!connectThingSpeak()){
+                // Failed to connect to ThingSpeak
+                return TS_ERR_CONNECT_FAILED;
+            }
+            
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::serviceUpdateQueue   (urgent update, channelNumber: "); Serial.print(channelNumber); Serial.print(" writeAPIKey: "); Serial.println(writeAPIKey);
+            #endif
+            
+            return writeStagedUpdate(writeAPIKey, this->urgentWrite);
+        }
+        
+        void recordLaneLatency(int lane, unsigned long latency)
+        {
+            this->laneLatency[lane] = latency;
+            if(latency > this->laneMaxLatency[lane]) this->laneMaxLatency[lane] = latency;
+        }
+        
+        // sends the values of one staging slot as an update, on a connection that is already open
+        int writeStagedUpdate(const char * writeAPIKey, writeStaging & sending)
+        {
+            // Get the content length of the payload
+            int contentLen = getWriteFieldsContentLength(sending);
+            
+            if(contentLen == 0){
+                // setField was not called before writeFields
+                return TS_ERR_SETFIELD_NOT_CALLED;
+            }
+            
+            // Post data to thingspeak
+            if(!writeUpdateHeader(writeAPIKey, contentLen)) return abortRequest();
+                
+            bool fFirstItem = true;
+            for(size_t iField = 0; iField < FIELDNUM_MAX; iField++){
+                if(sending.field[iField].length() > 0){
+                    if(!fFirstItem){
+                        if(!this->client->print("&")) return abortRequest();
+                    }
+                    if(!this->client->print("field")) return abortRequest();
+                    if(!this->client->print(iField + 1)) return abortRequest();
+                    if(!this->client->print("=")) return abortRequest();
+                    if(!this->client->print(sending.field[iField])) return abortRequest();
+                    fFirstItem = false;
+                }
+            }
+            
+            if(!isnan(sending.latitude)){
+                if(!fFirstItem){
+                    if(!this->client->print("&")) return abortRequest();
+                }
+                if(!this->client->print("lat=")) return abortRequest();
+                if(!this->client->print(sending.latitude)) return abortRequest();
+                fFirstItem = false;
+            }
+
+            if(!isnan(sending.longitude)){
+                if(!fFirstItem){
+                    if(!this->client->print("&")) return abortRequest();
+                }
+                if(!this->client->print("long=")) return abortRequest();
+                if(!this->client->print(sending.longitude)) return abortRequest();
+                fFirstItem = false;
+            }
+
+            if(!isnan(sending.elevation)){
+                if(!fFirstItem){
+                    if(!this->client->print("&")) return abortRequest();
+                }
+                if(!this->client->print("elevation=")) return abortRequest();
+                if(!this->client->print(sending.elevation)) return abortRequest();
+                fFirstItem = false;
+            }
+            
+            if(sending.status.length() > 0){
+                if(!fFirstItem){
+                    if(!this->client->print("&")) return abortRequest();
+                }
+                if(!this->client->print("status=")) return abortRequest();
+                if(!this->client->print(sending.status)) return abortRequest();
+                fFirstItem = false;
+            }
+            
+            if(sending.createdAt.length() > 0){
+                if(!fFirstItem){
+                    if(!this->client->print("&")) return abortRequest();
+                }
+                if(!this->client->print("created_at=")) return abortRequest();
+                if(!this->client->print(sending.createdAt)) return abortRequest();
+                fFirstItem = false;
+            }
+
+            if(!this->client->print("&headers=false")) return abortRequest();
+            
+            return finishWrite();
+        }
+        
+        int getWriteFieldsContentLength(writeStaging & staged){
+            size_t iField;
+            int contentLen = 0;
+            
+            for(iField = 0; iField < FIELDNUM_MAX; iField++){
+                if(staged.field[iField].length() > 0){
+                    contentLen = contentLen + 8 + staged.field[iField].length();	// &fieldX=[value]
+                    
+                    // future-proof in case ThingSpeak allows 999 fields someday
+                    if(iField > 9){
+                        contentLen = contentLen + 1;
+                    }
+                    else if(iField > 99){
+                        contentLen = contentLen + 2;
+                    }
+                    
+                }
+            }
+            
+            if(!isnan(staged.latitude)){
+                contentLen = contentLen + 5 + String(staged.latitude).length(); // &lat=[value]
+            }
+            
+            if(!isnan(staged.longitude)){
+                contentLen = contentLen + 6 + String(staged.longitude).length(); // &long=[value]
+            }
+            
+            if(!isnan(staged.elevation)){
+                contentLen = contentLen + 11 + String(staged.elevation).length(); // &elevation=[value]
+            }
+            
+            if(staged.status.length() > 0){
+                contentLen = contentLen + 8 + staged.status.length();	// &status=[value]
+            }
+            
+            if(staged.createdAt.length() > 0){
+                contentLen = contentLen + 12 + staged.createdAt.length();	// &created_at=[value]
+            }
+            
+            if(contentLen == 0){
+                return 0;
+            }
+            
+            contentLen = contentLen + 13; // add 14 for '&headers=false', subtract 1 for missing first '&'
+            
+            return contentLen;
+        }
+        
+        void emptyStream(){
+            // drop what is left of the response, a buffer at a time
+            this->responseBufferPos = 0;
+            this->responseBufferLength = 0;
+            int count;
+            while((count = this->client->available()) > 0){
+                if(count > RESPONSEBUFFER_SIZE) count = RESPONSEBUFFER_SIZE;
+                if(this->client->read(this->responseBuffer, count) <= 0) break;
+            }
+        }
+        
+        int finishWrite(){
+            String entryIDText = String();
+            int status = getHTTPResponse(entryIDText);
+            
+            emptyStream();
+            
+            if(status != TS_OK_SUCCESS)
+            {
+                this->client->stop();
+                return status;
+            }
+            long entryID = entryIDText.toInt();
+
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("               Entry ID \"");Serial.print(entryIDText);Serial.print("\" (");Serial.print(entryID);Serial.println(")");
+            #endif
+            
+            finishConnection(status);
+            
+            if(entryID == 0)
+            {
+                // ThingSpeak did not accept the write
+                status = TS_ERR_NOT_INSERTED;
+            }
+            
+            return status;
+        }
+        
+        String getJSONValueByKey(String textToSearch, String key)
+        {
+            if(textToSearch.length() == 0){
+                return String("");
+            }
+            
+            String searchPhrase = String("\"");
+            searchPhrase.concat(key);
+            searchPhrase.concat("\":\"");
+            
+            int fromPosition = textToSearch.indexOf(searchPhrase,0);
+            
+            if(fromPosition == -1){
+                // return because there is no status or it's null
+                return String("");
+            }
+            
+            fromPosition = fromPosition + searchPhrase.length();
+                    
+            int toPosition = textToSearch.indexOf("\"", fromPosition);
+            
+            
+            if(toPosition == -1){
+                // return because there is no end quote
+                return String("");
+            }
+            
+            textToSearch.remove(toPosition);
+            
+            return textToSearch.substring(fromPosition);
+        }
+        
+        long getJSONNumberByKey(String & textToSearch, const char * key)
+        {
+            String searchPhrase = String("\"");
+            searchPhrase.concat(key);
+            searchPhrase.concat("\":");
+            
+            int fromPosition = textToSearch.indexOf(searchPhrase);
+            
+            if(fromPosition == -1){
+                // return because the key is missing
+                return 0;
+            }
+            
+            return atol(textToSearch.c_str() + fromPosition + searchPhrase.length());
+        }
+        
+        #ifndef ARDUINO_AVR_UNO
+            String parseValues(String & multiContent, String key)
+            {
+                if(multiContent.length() == 0){
+                    return String("");
+                }
+                
+                String searchPhrase = String("\"");
+                searchPhrase.concat(key);
+                searchPhrase.concat("\":\"");
                 
-                if(getLastReadStatus() != TS_OK_SUCCESS){
-                    return getLastReadStatus();
+                int fromPosition = multiContent.indexOf(searchPhrase,0);
+                
+                if(fromPosition == -1){
+                    // return because there is no status or it's null
+                    return String("");
                 }
                 
-                this->lastFeed.nextReadField[0] = parseValues(multiContent, "field1");
-                this->lastFeed.nextReadField[1] = parseValues(multiContent, "field2");
-                this->lastFeed.nextReadField[2] = parseValues(multiContent, "field3");
-                this->lastFeed.nextReadField[3] = parseValues(multiContent, "field4");
-                this->lastFeed.nextReadField[4] = parseValues(multiContent, "field5");
-                this->lastFeed.nextReadField[5] = parseValues(multiContent, "field6");
-                this->lastFeed.nextReadField[6] = parseValues(multiContent, "field7");
-                this->lastFeed.nextReadField[7] = parseValues(multiContent, "field8");
-                this->lastFeed.nextReadCreatedAt = parseValues(multiContent, "created_at");
-                this->lastFeed.nextReadLatitude = parseValues(multiContent, "latitude");
-                this->lastFeed.nextReadLongitude = parseValues(multiContent, "longitude");
-                this->lastFeed.nextReadElevation = parseValues(multiContent, "elevation");
-                this->lastFeed.nextReadStatus = parseValues(multiContent, "status");
+                fromPosition = fromPosition + searchPhrase.length();
+                        
+                int toPosition = multiContent.indexOf("\"", fromPosition);
                 
-                return TS_OK_SUCCESS;
+                
+                if(toPosition == -1){
+                    // return because there is no end quote
+                    return String("");
+                }
+                
+                return multiContent.substring(fromPosition, toPosition);
+            }
+        #endif
+        
+        int requestTalkBackCommand(unsigned long talkBackID, const char * talkBackAPIKey, String & command)
+        {
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::executeTalkBackCommand (talkBackID: "); Serial.print(talkBackID); Serial.println(")");
+            #endif
+            
+            if(!connectThingSpeak())
+            {
+                return TS_ERR_CONNECT_FAILED;
+            }
+            
+            if(!writeRequestLine("POST ", "/talkbacks/")) return abortRequest();
+            if(!this->client->print(talkBackID)) return abortRequest();
+            if(!this->client->print("/commands/execute HTTP/1.1\r\n")) return abortRequest();
+            if(!writeHTTPHeader(NULL)) return abortRequest();
+            if(!this->client->print("Content-Type: application/x-www-form-urlencoded\r\n")) return abortRequest();
+            if(!this->client->print("Content-Length: ")) return abortRequest();
+            if(!this->client->print(8 + strlen(talkBackAPIKey))) return abortRequest(); // api_key=[key]
+            if(!this->client->print("\r\n\r\napi_key=")) return abortRequest();
+            if(!this->client->print(talkBackAPIKey)) return abortRequest();
+            
+            int status = getHTTPResponse(command);
+            
+            emptyStream();
+            finishConnection(status);
+            
+            return status;
+        }
+        
+        // Print that only counts what is printed, for computing a Content-Length before sending
+        class lengthCounter : public Print
+        {
+          public:
+            lengthCounter() : length(0) {}
+            size_t write(uint8_t) { length++; return 1; }
+            size_t write(const uint8_t *, size_t size) { length += size; return size; }
+            size_t length;
+        };
+        
+        size_t printBulkValue(Print & out, float value)
+        {
+            // shortest form of the value, "21.5" rather than "21.50000"
+            char valueString[20];
+            if(isnan(value) || convertFloatToChar(value, valueString) != TS_OK_SUCCESS)
+            {
+                return 0;
+            }
+            if(NULL != strchr(valueString, '.'))
+            {
+                char * end = valueString + strlen(valueString) - 1;
+                while(*end == '0') *end-- = 0;
+                if(*end == '.') *end = 0;
+            }
+            return out.print(valueString);
+        }
+        
+        size_t printBulkCSV(Print & out, const char * writeAPIKey, queuedUpdate * queue, unsigned int queueSize, unsigned int queueStart, unsigned int numUpdates, bool absoluteTime)
+        {
+            size_t length = 0;
+            length += out.print("write_api_key=");
+            length += out.print(writeAPIKey);
+            length += out.print(absoluteTime ? "&time_format=absolute&updates=" : "&time_format=relative&updates=");
+            
+            uint32_t firstTime = queue[queueStart].time;
+            uint32_t previousSeconds = 0;
+            for(unsigned int i = 0; i < numUpdates; i++)
+            {
+                queuedUpdate & update = queue[(queueStart + i) % queueSize];
+                
+                // seconds since the previous update (or the timestamp), then the 8 fields, latitude, longitude, elevation and status
+                // (offsets are taken from whole seconds since the first update so rounding doesn't add up)
+                uint32_t seconds = (update.time - firstTime) / 1000;
+                if(i > 0) length += out.print("|");
+                length += out.print((unsigned long)(absoluteTime ? update.time : seconds - previousSeconds));
+                for(size_t iField = 0; iField < FIELDNUM_MAX; iField++)
+                {
+                    length += out.print(",");
+                    length += printBulkValue(out, update.field[iField]);
+                }
+                length += out.print(",,,,");
+                previousSeconds = seconds;
+            }
+            return length;
+        }
+        
+        // takes the fields set with setField() into a queue, dropping the oldest update or decimating when the queue is full
+        int appendQueuedUpdate(queuedUpdate * queue, unsigned int queueSize, unsigned int & queueStart, unsigned int & queueCount, unsigned long & queueDropped)
+        {
+            queuedUpdate update;
+            bool anyField = false;
+            update.time = millis();
+            update.samples = 1;
+            writeStaging & staged = takeStagedWrite();
+            for(size_t iField = 0; iField < FIELDNUM_MAX; iField++)
+            {
+                update.field[iField] = (staged.field[iField].length() > 0) ? convertCharToFloat(staged.field[iField].c_str()) : NAN;
+                anyField = anyField || !isnan(update.field[iField]);
+            }
+            clearStagedWrite(staged);
+            if(!anyField)
+            {
+                return TS_ERR_SETFIELD_NOT_CALLED;
+            }
+            
+            if(queueCount == queueSize && !(this->queueOverflow == TS_QUEUE_DECIMATE && decimateQueue(queue, queueSize, queueStart, queueCount)))
+            {
+                queueStart = (queueStart + 1) % queueSize;
+                queueCount--;
+                queueDropped++;
+            }
+            queue[(queueStart + queueCount) % queueSize] = update;
+            queueCount++;
+            return TS_OK_SUCCESS;
+        }
+        
+        // merges the two oldest updates of the smallest weight that occurs twice, so the weights stay powers of two that shrink from the oldest
+        // update to the newest and every merge halves the resolution of the oldest updates that still have the finest one
+        bool decimateQueue(queuedUpdate * queue, unsigned int queueSize, unsigned int & queueStart, unsigned int & queueCount)
+        {
+            int pair = -1;
+            for(unsigned int i = 0; i + 1 < queueCount; i++)
+            {
+                uint16_t samples = queue[(queueStart + i) % queueSize].samples;
+                if(samples == queue[(queueStart + i + 1) % queueSize].samples && samples <= 0x7FFF && (pair < 0 || samples < queue[(queueStart + pair) % queueSize].samples))
+                {
+                    pair = i;
+                }
+            }
+            if(pair < 0)
+            {
+                return false;
+            }
+            
+            queuedUpdate & older = queue[(queueStart + pair) % queueSize];
+            queuedUpdate & newer = queue[(queueStart + pair + 1) % queueSize];
+            newer.time = older.time + (newer.time - older.time) / 2;
+            for(size_t iField = 0; iField < FIELDNUM_MAX; iField++)
+            {
+                float a = older.field[iField];
+                float b = newer.field[iField];
+                if(isnan(a) || isnan(b))
+                {
+                    newer.field[iField] = isnan(b) ? a : b;
+                }
+                else if(this->fieldDecimation[iField] == TS_DECIMATE_MIN)
+                {
+                    newer.field[iField] = (a < b) ? a : b;
+                }
+                else if(this->fieldDecimation[iField] == TS_DECIMATE_MAX)
+                {
+                    newer.field[iField] = (a > b) ? a : b;
+                }
+                else
+                {
+                    newer.field[iField] = (a + b) / 2;
+                }
+            }
+            newer.samples = older.samples * 2;
+            
+            // the updates older than the pair move up into the freed slot
+            for(int i = pair; i > 0; i--)
+            {
+                queue[(queueStart + i) % queueSize] = queue[(queueStart + i - 1) % queueSize];
+            }
+            queueStart = (queueStart + 1) % queueSize;
+            queueCount--;
+            return true;
+        }
+        
+        // sends up to BULK_UPDATES_MAX updates of a non-empty queue, and removes them from the queue once ThingSpeak accepted them
+        // (the time of an update is millis() when it was queued, or with absoluteTime its timestamp in seconds since 1970-01-01 UTC)
+        int writeBulkUpdate(unsigned long channelNumber, const char * writeAPIKey, queuedUpdate * queue, unsigned int queueSize, unsigned int & queueStart, unsigned int & queueCount, bool absoluteTime)
+        {
+            unsigned int numUpdates = (queueCount < BULK_UPDATES_MAX) ? queueCount : BULK_UPDATES_MAX;
+            
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::writeBulkUpdate (channelNumber: "); Serial.print(channelNumber); Serial.print(" updates: "); Serial.print(numUpdates); Serial.println(")");
+            #endif
+            
+            invalidateReadCache(channelNumber);
+            
+            if(!connectThingSpeak())
+            {
+                // Failed to connect to ThingSpeak
+                return TS_ERR_CONNECT_FAILED;
+            }
+            
+            // Dry pass to get the content length without building the body in memory
+            lengthCounter counter;
+            printBulkCSV(counter, writeAPIKey, queue, queueSize, queueStart, numUpdates, absoluteTime);
+            
+            if(!writeRequestLine("POST ", "/channels/")) return abortRequest();
+            if(!this->client->print(channelNumber)) return abortRequest();
+            if(!this->client->print("/bulk_update.csv HTTP/1.1\r\n")) return abortRequest();
+            if(!writeHTTPHeader(NULL)) return abortRequest();
+            if(!this->client->print("Content-Type: application/x-www-form-urlencoded\r\n")) return abortRequest();
+            if(!this->client->print("Content-Length: ")) return abortRequest();
+            if(!this->client->print(counter.length)) return abortRequest();
+            if(!this->client->print("\r\n\r\n")) return abortRequest();
+            if(printBulkCSV(*this->client, writeAPIKey, queue, queueSize, queueStart, numUpdates, absoluteTime) != counter.length) return abortRequest();
+            
+            String response = String();
+            int status = getHTTPResponse(response);
+            
+            emptyStream();
+            finishConnection(status);
+            
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("               Bulk update status "); Serial.print(status); Serial.print(" \""); Serial.print(response); Serial.println("\"");
+            #endif
+            
+            if(status != TS_OK_SUCCESS && status != TS_OK_ACCEPTED)
+            {
+                return status;
+            }
+            if(response.indexOf("true") == -1)
+            {
+                // ThingSpeak did not accept the updates
+                return TS_ERR_NOT_INSERTED;
+            }
+            
+            queueStart = (queueStart + numUpdates) % queueSize;
+            queueCount -= numUpdates;
+            
+            return TS_OK_SUCCESS;
+        }
+        
+        // slot for the next captured value with its field and time set, or NULL when it can't be taken
+        TS_ISR_ATTR capturedSample * nextCaptureSlot(unsigned int field)
+        {
+            unsigned int size = this->captureSize;
+            if(field < FIELDNUM_MIN || field > FIELDNUM_MAX || 0 == size)
+            {
+                return NULL;
+            }
+            unsigned int head = this->captureHead;
+            unsigned int next = (head + 1 == size) ? 0 : head + 1;
+            if(next == this->captureTail)
+            {
+                this->captureDropped = this->captureDropped + 1;
+                return NULL;
+            }
+            capturedSample * sample = &this->captureBuffer[head];
+            sample->time = millis();
+            sample->field = field;
+            return sample;
+        }
+        
+        // makes the slot filled after nextCaptureSlot() visible to readCapturedSample()
+        TS_ISR_ATTR void publishCapturedSample()
+        {
+            unsigned int head = this->captureHead;
+            captureBarrier();
+            this->captureHead = (head + 1 == this->captureSize) ? 0 : head + 1;
+        }
+        
+        // index of the next slot the interrupt fills, read in one piece also where an int takes two loads
+        unsigned int capturedHead()
+        {
+            #if defined(__AVR__)
+                uint8_t oldSREG = SREG;
+                cli();
+                unsigned int head = this->captureHead;
+                SREG = oldSREG;
+                return head;
+            #else
+                return this->captureHead;
+            #endif
+        }
+        
+        // frees the slots before tail, stored in one piece also where an int takes two stores
+        void setCapturedTail(unsigned int tail)
+        {
+            #if defined(__AVR__)
+                uint8_t oldSREG = SREG;
+                cli();
+                this->captureTail = tail;
+                SREG = oldSREG;
+            #else
+                this->captureTail = tail;
+            #endif
+        }
+        
+        // keeps the compiler from moving the sample copy across the index update
+        TS_ISR_ATTR static inline void captureBarrier()
+        {
+            __asm__ __volatile__("" ::: "memory");
+        }
+        
+        // reads one line of a backfilled log, and adds it to the rows of the job if it is a row
+        void readBackfillRow(backfillJob & job, Stream & log)
+        {
+            char line[BACKFILL_LINE_MAX];
+            size_t length = 0;
+            bool overlong = false;
+            while(true)
+            {
+                int c = log.read();
+                if(c < 0)
+                {
+                    job.ended = true;
+                    if(0 == length) return;
+                    break;
+                }
+                job.readOffset++;
+                if(c == '\n') break;
+                if(c == '\r') continue;
+                if(length < BACKFILL_LINE_MAX - 1) line[length++] = c;
+                else overlong = true;
+            }
+            line[length] = 0;
+            if(0 == length)
+            {
+                return;
+            }
+            
+            queuedUpdate row;
+            bool anyField = false;
+            row.samples = 1;
+            char * value = line;
+            char * comma = strchr(value, ',');
+            if(NULL != comma) *comma = 0;
+            row.time = (strlen(value) >= 19) ? convertTimestampToEpoch(value) : strtoul(value, NULL, 10);
+            for(size_t iField = 0; iField < FIELDNUM_MAX; iField++)
+            {
+                row.field[iField] = NAN;
+                if(NULL == comma) continue;
+                value = comma + 1;
+                comma = strchr(value, ',');
+                if(NULL != comma) *comma = 0;
+                row.field[iField] = convertCharToFloat(value);
+                anyField = anyField || !isnan(row.field[iField]);
+            }
+            
+            if(overlong || !isdigit(line[0]) || !anyField || 0 == row.time)
+            {
+                job.rowsSkipped++;
+                return;
+            }
+            job.updates[job.count++] = row;
+        }
+        
+        gatewayChannel * findGatewayChannel(unsigned long channelNumber)
+        {
+            for(unsigned int i = 0; i < this->numGatewayChannels; i++)
+            {
+                if(this->gatewayChannels[i].channelNumber == channelNumber)
+                {
+                    return &this->gatewayChannels[i];
+                }
+            }
+            return NULL;
+        }
+        
+        // ends a failed request, the values the sketch is setting meanwhile are kept, writeFields() clears the ones it was sending itself
+        int abortRequest()
+        {
+            emptyStream();
+            this->client->stop();
+            
+            return TS_ERR_UNEXPECTED_FAIL;
+        }
+        
+        // a kept-alive or prepared connection that the server has closed may still take a request, which then fails while sending or times out
+        // without a response; nothing has reached ThingSpeak in that case, so the caller sends the request once more on a new connection
+        bool resendOnNewConnection(int status)
+        {
+            if(!this->connectionReused || this->responseStarted || (status != TS_ERR_UNEXPECTED_FAIL && status != TS_ERR_TIMEOUT))
+            {
+                return false;
+            }
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.println("               Reused connection is closed, sending again on a new one.");
+            #endif
+            this->client->stop();
+            return true;
+        }
+
+        String abortReadRaw()
+        {
+            emptyStream();
+            this->client->stop();
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.println("ReadRaw abort - disconnected.");
+            #endif
+            this->lastReadStatus = TS_ERR_UNEXPECTED_FAIL;
+            return String("");
+        }
+        
+        // sends a GET for readURL and reads the header of the response, a request that went out on a closed reused connection is sent once more
+        int requestRead(String & readURL, const char * readAPIKey, int & contentLength)
+        {
+            int status = sendReadRequest(readURL, readAPIKey, contentLength);
+            if(resendOnNewConnection(status))
+            {
+                status = sendReadRequest(readURL, readAPIKey, contentLength);
+            }
+            return status;
+        }
+        
+        int sendReadRequest(String & readURL, const char * readAPIKey, int & contentLength)
+        {
+            if(!connectThingSpeak())
+            {
+                return TS_ERR_CONNECT_FAILED;
+            }
+            if(!writeHTTPGet(readURL, readAPIKey))
+            {
+                abortReadRaw();
+                return this->lastReadStatus;
+            }
+            return getHTTPResponseHeader(contentLength);
+        }
+
+        timeSeries * getFieldSeries(unsigned int field)
+        {
+            if(field < FIELDNUM_MIN || field > FIELDNUM_MAX)
+            {
+                return NULL;
+            }
+            return this->fieldSeries[field - 1];
+        }
+
+        uint32_t getSeriesTime()
+        {
+            if(NULL != this->seriesClock)
+            {
+                return this->seriesClock();
+            }
+            return millis() / 1000;
+        }
+
+        void recordSeriesSample(unsigned int field, String & value)
+        {
+            timeSeries * series = getFieldSeries(field);
+            if(NULL == series)
+            {
+                return;
+            }
+            float sample = convertCharToFloat(value.c_str());
+            if(!isnan(sample))
+            {
+                appendSeriesSample(series, getSeriesTime(), sample, true);
+            }
+        }
+
+        bool appendSeriesSample(timeSeries * series, uint32_t sampleTime, float sample, bool allowSameTime)
+        {
+            if(0 == series->capacity)
+            {
+                return false;
             }
-            
-            
-            /*
-            Function: readMultipleFields
-            
-            Summary:
-            Read all the field values, status message, location coordinates, and created-at timestamp associated with the latest update to a private ThingSpeak channel and store the values locally in variables within a struct.
-             
-            Parameters:
-            channelNumber - Channel number
-            readAPIKey - Read API key associated with the channel. *If you share code with others, do _not_ share this key*
-             
-            Returns:
-            HTTP status code of 200 if successful.
-            
-            Notes:
-            See getLastReadStatus() for other possible return values.
-            */
-            int readMultipleFields(unsigned long channelNumber)
+            if(series->count > 0)
             {
-                return readMultipleFields(channelNumber, NULL);
+                // keep the ring sorted by time so it can be searched
+                uint32_t latestTime = series->time[(series->start + series->count - 1) % series->capacity];
+                if(sampleTime < latestTime || (sampleTime == latestTime && !allowSameTime))
+                {
+                    return false;
+                }
             }
             
-            
-            /*
-            Function: getFieldAsString
-             
-            Summary:
-            Fetch the value as string from the latest stored feed record.
-            
-            Parameters:
-            field - Field number (1-8) within the channel to read from.
-            
-            Returns:
-            Value read (UTF8 string), empty string if there is an error, or old value read (UTF8 string) if invoked before readMultipleFields().  Use getLastReadStatus() to get more specific information.
-            */
-            String getFieldAsString(unsigned int field)
+            unsigned int slot;
+            if(series->count < series->capacity)
             {
-                if(field < FIELDNUM_MIN || field > FIELDNUM_MAX)
+                slot = (series->start + series->count) % series->capacity;
+                series->count++;
+            }
+            else
+            {
+                // full, replace the oldest sample
+                slot = series->start;
+                series->start = (series->start + 1) % series->capacity;
+            }
+            series->time[slot] = sampleTime;
+            series->value[slot] = sample;
+            return true;
+        }
+
+        unsigned int findSeriesIndex(timeSeries * series, uint32_t sampleTime)
+        {
+            // binary search for the first sample at or after sampleTime, as an offset from the oldest sample
+            unsigned int low = 0;
+            unsigned int high = series->count;
+            while(low < high)
+            {
+                unsigned int middle = low + (high - low) / 2;
+                if(series->time[(series->start + middle) % series->capacity] < sampleTime)
                 {
-                    this->lastReadStatus = TS_ERR_INVALID_FIELD_NUM;
-                    return("");
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle;
                 }
-                
-                this->lastReadStatus = TS_OK_SUCCESS;
-                return this->lastFeed.nextReadField[field-1];
+            }
+            return low;
+        }
+
+        unsigned long hashReadCacheKey(const char * APIKey)
+        {
+            // FNV-1a, so the API key itself is not kept in the cache
+            unsigned long hash = 2166136261UL;
+            if(NULL != APIKey)
+            {
+                while(*APIKey)
+                {
+                    hash = (hash ^ (unsigned char)*APIKey++) * 16777619UL;
+                }
+            }
+            return hash;
+        }
+
+        readCacheEntry * findReadCacheEntry(unsigned long channelNumber, String & suffixURL, const char * APIKey)
+        {
+            if(NULL == this->readCache || suffixURL.length() >= READCACHE_SUFFIX_MAX)
+            {
+                return NULL;
             }
             
+            unsigned long keyHash = hashReadCacheKey(APIKey);
+            for(unsigned int i = 0; i < this->readCacheSize; i++)
+            {
+                readCacheEntry * entry = &this->readCache[i];
+                if(entry->valid && entry->channelNumber == channelNumber && entry->keyHash == keyHash && suffixURL.equals(entry->suffixURL))
+                {
+                    if(millis() - entry->storedAt < this->readCacheTTL)
+                    {
+                        return entry;
+                    }
+                    entry->valid = false; // expired
+                    return NULL;
+                }
+            }
+            return NULL;
+        }
+
+        void storeReadCacheEntry(unsigned long channelNumber, String & suffixURL, const char * APIKey, String & value)
+        {
+            if(NULL == this->readCache || 0 == this->readCacheSize || suffixURL.length() >= READCACHE_SUFFIX_MAX || value.length() >= READCACHE_VALUE_MAX)
+            {
+                return;
+            }
             
-            /*
-            Function: getFieldAsFloat
-             
-            Summary:
-            Fetch the value as float from the latest stored feed record.
-            
-            Parameters:
-            field - Field number (1-8) within the channel to read from.
+            // take a free slot if there is one, otherwise replace the oldest entry
+            readCacheEntry * slot = &this->readCache[0];
+            for(unsigned int i = 0; i < this->readCacheSize; i++)
+            {
+                readCacheEntry * entry = &this->readCache[i];
+                if(!entry->valid)
+                {
+                    slot = entry;
+                    break;
+                }
+                if(slot->valid && (millis() - entry->storedAt) > (millis() - slot->storedAt))
+                {
+                    slot = entry;
+                }
+            }
             
-            Returns:
-            Value read, 0 if the field is text or there is an error, or old value read if invoked before readMultipleFields(). Use getLastReadStatus() to get more specific information.  Note that NAN, INFINITY, and -INFINITY are valid results.
-            */
-            float getFieldAsFloat(unsigned int field)
+            slot->channelNumber = channelNumber;
+            slot->keyHash = hashReadCacheKey(APIKey);
+            slot->storedAt = millis();
+            suffixURL.toCharArray(slot->suffixURL, READCACHE_SUFFIX_MAX);
+            value.toCharArray(slot->value, READCACHE_VALUE_MAX);
+            slot->valid = true;
+        }
+
+        void invalidateReadCache(unsigned long channelNumber)
+        {
+            for(unsigned int i = 0; i < this->readCacheSize; i++)
             {
-                return convertStringToFloat(getFieldAsString(field));
+                if(this->readCache[i].channelNumber == channelNumber)
+                {
+                    this->readCache[i].valid = false;
+                }
+            }
+        }
+
+        void setEndpoint(Client & client, const char * hostName, unsigned int port, const char * pathPrefix, const char * hostHeader)
+        {
+            // a kept-alive or prepared connection goes to the previous server
+            if(NULL != this->client && this->client->connected())
+            {
+                this->client->stop();
             }
+            this->prepared = false;
             
+            this->setClient(&client);
+            this->setPort(port);
+            this->hostName = hostName;
+            this->pathPrefix = (NULL == pathPrefix) ? "" : pathPrefix;
+            this->hostHeader = (NULL != hostHeader) ? hostHeader : ((NULL != hostName) ? hostName : THINGSPEAK_URL);
             
-            /*
-            Function: getFieldAsLong
+            // prepared headers and cached values belong to the previous server
+            for(unsigned int i = 0; i < this->requestHeaderCount; i++)
+            {
+                this->requestHeaders[i].keyOffset = 0;
+            }
+            clearReadCache();
             
-            Summary:
-            Fetch the value as long from the latest stored feed record.
+            resetWriteFields();
+            this->lastReadStatus = TS_OK_SUCCESS;
+        }
+        
+        void setPort(unsigned int port)
+        {
+            this->port = port;
+        }
+        
+        void setClient(Client * client)
+        {
+            this->client = client;
             
-            Parameters:
-            field - Field number (1-8) within the channel to read from.
+        }
+        
+        Client * client = NULL;
+        unsigned int port = THINGSPEAK_PORT_NUMBER;
+        const char * hostName = THINGSPEAK_URL;   // NULL when the server is addressed by hostIP
+        IPAddress hostIP;
+        const char * pathPrefix = "";
+        const char * hostHeader = THINGSPEAK_URL;
+        writeStaging stagedWrites[2];
+        uint8_t nextWriteSlot = 0; // slot of stagedWrites that the set functions write to
+        #if defined(ARDUINO_ARCH_ESP32)
+            SemaphoreHandle_t stagingLock; // guards nextWriteSlot and the slot it selects
+        #endif
+        int lastReadStatus;
+        #ifndef ARDUINO_AVR_UNO
+            feed lastFeed;
+            unsigned long lastFeedChannelNumber = 0;
+            long lastFeedEntryID = 0;
+        #endif
+        int bodyRemaining = 0;
+        int bodyPushback = -1;
+        uint8_t responseBuffer[RESPONSEBUFFER_SIZE];
+        uint8_t responseBufferPos = 0;
+        uint8_t responseBufferLength = 0;
+        timeSeries * fieldSeries[8];
+        fieldSchedule * fieldSchedules[8];
+        unsigned long scheduleInterval;
+        unsigned long scheduleLastWrite;
+        bool scheduleWritten;
+        uint32_t (*seriesClock)();
+        int feedFormat;
+        queuedUpdate * updateQueue;
+        unsigned int updateQueueSize;
+        unsigned int updateQueueStart;
+        unsigned int updateQueueCount;
+        unsigned long updateQueueDropped;
+        int queueOverflow;
+        uint8_t fieldDecimation[8];
+        unsigned long updateQueueInterval;
+        unsigned long updateQueueLastWrite;
+        bool updateQueueWritten;
+        writeStaging urgentWrite;      // the urgent lane, one update that merges what queueUrgentFields() was given
+        bool urgentPending;
+        unsigned long urgentQueuedAt;
+        unsigned long laneLatency[2];  // indexed by TS_LANE_URGENT and TS_LANE_BULK
+        unsigned long laneMaxLatency[2];
+        unsigned int mirrorAppended;
+        capturedSample * captureBuffer;
+        volatile unsigned int captureSize;
+        volatile unsigned int captureHead;  // next slot captureField() fills, only changed by the capturing interrupt
+        volatile unsigned int captureTail;  // oldest waiting value, only changed by readCapturedSample()
+        volatile unsigned long captureDropped;
+        gatewayChannel * gatewayChannels;
+        unsigned int numGatewayChannels;
+        unsigned long gatewayInterval;
+        unsigned int gatewayNext;
+        unsigned long gatewayLast;
+        bool keepAlive;
+        bool connectionReused;
+        bool responseStarted;       // some of the response to the current request has arrived
+        unsigned long lastActivity;
+        bool prepared;
+        unsigned long preparedAt;
+        unsigned long prepareWarmMS;
+        unsigned long talkBackID;
+        const char * talkBackAPIKey;
+        talkBackCommand * talkBackQueue;
+        unsigned int talkBackQueueSize;
+        unsigned int talkBackQueueStart;
+        unsigned int talkBackQueueCount;
+        unsigned long talkBackMinIntervalMS;
+        unsigned long talkBackMaxIntervalMS;
+        unsigned long talkBackIntervalMS;
+        unsigned long talkBackLastPoll;
+        bool talkBackPolled;
+        channelInfo * channelInfoRecord;
+        requestHeader * requestHeaders;
+        unsigned int requestHeaderCount;
+        unsigned int requestHeaderNext;
+        readCacheEntry * readCache;
+        unsigned int readCacheSize;
+        unsigned long readCacheTTL;
+        unsigned long readCacheHits;
+        unsigned long readCacheMisses;
+
+        bool connectThingSpeak()
+        {
+            bool connectSuccess = false;
             
-            Returns:
-            Value read, 0 if the field is text or there is an error, or old value read if invoked before readMultipleFields(). Use getLastReadStatus() to get more specific information.
-            */
-            long getFieldAsLong(unsigned int field)
+            this->connectionReused = false;
+            this->responseStarted = false;
+            if(this->client->connected())
             {
-                // Note that although the function is called "toInt" it really returns a long.
-                return getFieldAsString(field).toInt();
+                // a kept-alive connection, or one opened in advance by prepare(), which is used by one request only
+                bool warm = (this->keepAlive && millis() - this->lastActivity < KEEPALIVE_IDLE_MS) ||
+                            (this->prepared && millis() - this->preparedAt < this->prepareWarmMS);
+                this->prepared = false;
+                if(warm)
+                {
+                    #ifdef PRINT_DEBUG_MESSAGES
+                        Serial.println("               Reusing connection to ThingSpeak.");
+                    #endif
+                    emptyStream();
+                    this->connectionReused = true;
+                    return true;
+                }
+                // the server has probably closed it by now
+                this->client->stop();
             }
+            this->prepared = false;
             
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("               Connect to ThingSpeak: ");
+                if(NULL != this->hostName)
+                {
+                    Serial.print(this->hostName);
+                }
+                else
+                {
+                    Serial.print(this->hostIP);
+                }
+                Serial.print(":");
+                Serial.print(this->port);
+                Serial.print("...");
+            #endif
             
-            /*
-            Function: getFieldAsInt
-             
-            Summary:
-            Fetch the value as int from the latest stored feed record.
-            
-            Parameters:
-            field - Field number (1-8) within the channel to read from.
-            
-            Returns:
-            Value read, 0 if the field is text or there is an error, or old value read if invoked before readMultipleFields(). Use getLastReadStatus() to get more specific information.
-            */
-            int getFieldAsInt(unsigned int field)
+            if(NULL != this->hostName)
             {
-                // int and long are same
-                return getFieldAsLong(field);
+                connectSuccess = client->connect(const_cast<char *>(this->hostName), this->port);
+            }
+            else
+            {
+                connectSuccess = client->connect(this->hostIP, this->port);
             }
-            
                 
-            /*
-            Function: getStatus
-             
-            Summary:
-            Fetch the status message associated with the latest stored feed record.
+            #ifdef PRINT_DEBUG_MESSAGES
+                if (connectSuccess)
+                {
+                    Serial.println("Success.");
+                }
+                else
+                {
+                    Serial.println("Failed.");
+                }
+            #endif
             
-            Results:
-            Value read (UTF8 string). An empty string is returned if there was no status written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
-            */
-            String getStatus()
+            return connectSuccess;
+        }
+
+        void finishConnection(int status)
+        {
+            // a connection can only be reused after a complete, successful response
+            if(this->keepAlive && (status == TS_OK_SUCCESS || status == TS_OK_ACCEPTED) && this->client->connected())
             {
-                return this->lastFeed.nextReadStatus;
+                this->lastActivity = millis();
+                return;
+            }
+            this->client->stop();
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.println("disconnected.");
+            #endif
+        }
+
+        requestHeader * getRequestHeader(const char * writeAPIKey)
+        {
+            if(0 == this->requestHeaderCount || NULL == writeAPIKey)
+            {
+                return NULL;
             }
             
-            
-            /*
-            Function: getLatitude
-             
-            Summary:
-            Fetch the latitude associated with the latest stored feed record.
-            
-            Results:
-            Value read (UTF8 string). An empty string is returned if there was no latitude written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
-            */
-            String getLatitude()
+            // the key itself is compared, a hash collision would send the update to the wrong channel
+            size_t keyLength = strlen(writeAPIKey);
+            for(unsigned int i = 0; i < this->requestHeaderCount; i++)
             {
-                return this->lastFeed.nextReadLatitude;
+                requestHeader * header = &this->requestHeaders[i];
+                if(header->keyOffset > 0 && header->keyLength == keyLength && 0 == memcmp(header->text + header->keyOffset, writeAPIKey, keyLength))
+                {
+                    return header;
+                }
             }
             
+            const char requestLine[] = "/update HTTP/1.1\r\nHost: ";
+            const char agent[] = "\r\nUser-Agent: " TS_USER_AGENT "\r\nX-THINGSPEAKAPIKEY: ";
+            const char suffix[] = "\r\nContent-Type: application/x-www-form-urlencoded\r\nContent-Length: ";
+            size_t prefixLength = 5 + strlen(this->pathPrefix) + (sizeof(requestLine) - 1) + strlen(this->hostHeader) + (sizeof(agent) - 1); // "POST " up to the API key
+            // leave room for the Content-Length value and the blank line
+            if(prefixLength + keyLength + sizeof(suffix) + 16 > REQUESTHEADER_MAX)
+            {
+                return NULL;
+            }
             
-            /*
-            Function: getLongitude
-             
-            Summary:
-            Fetch the longitude associated with the latest stored feed record.
+            requestHeader * header = &this->requestHeaders[this->requestHeaderNext];
+            this->requestHeaderNext = (this->requestHeaderNext + 1) % this->requestHeaderCount;
+            strcpy(header->text, "POST ");
+            strcat(header->text, this->pathPrefix);
+            strcat(header->text, requestLine);
+            strcat(header->text, this->hostHeader);
+            strcat(header->text, agent);
+            strcat(header->text, writeAPIKey);
+            strcat(header->text, suffix);
+            header->keyOffset = prefixLength;
+            header->keyLength = keyLength;
+            header->length = strlen(header->text);
             
-            Results:
-            Value read (UTF8 string). An empty string is returned if there was no longitude written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
-            */
-            String getLongitude()
+            return header;
+        }
+        
+        bool writeUpdateHeader(const char * writeAPIKey, unsigned int contentLength)
+        {
+            requestHeader * header = getRequestHeader(writeAPIKey);
+            if(NULL == header)
             {
-                return this->lastFeed.nextReadLongitude;
+                if(!writeRequestLine("POST ", "/update HTTP/1.1\r\n")) return false;
+                if(!writeHTTPHeader(writeAPIKey)) return false;
+                if(!this->client->print("Content-Type: application/x-www-form-urlencoded\r\n")) return false;
+                if(!this->client->print("Content-Length: ")) return false;
+                if(!this->client->print(contentLength)) return false;
+                if(!this->client->print("\r\n\r\n")) return false;
+                return true;
             }
             
+            // complete the prepared header in the room behind it and send it at once
+            char * tail = header->text + header->length;
+            ltoa((long)contentLength, tail, 10);
+            strcat(tail, "\r\n\r\n");
+            size_t headerLength = header->length + strlen(tail);
             
-            /*
-            Function: getElevation
-             
-            Summary:
-            Fetch the longitude associated with the latest stored feed record.
-            
-            Results:
-            Value read (UTF8 string). An empty string is returned if there was no elevation written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
-            */
-            String getElevation()
+            return this->client->write((const uint8_t *)header->text, headerLength) == headerLength;
+        }
+        
+        bool writeHTTPHeader(const char * APIKey)
+        {
+     
+            if (!this->client->print("Host: ")) return false;
+            if (!this->client->print(this->hostHeader)) return false;
+            if (!this->client->print("\r\n")) return false;
+            if (!this->client->print("User-Agent: ")) return false;
+            if (!this->client->print(TS_USER_AGENT)) return false;
+            if (!this->client->print("\r\n")) return false;
+            if(NULL != APIKey)
             {
-                return this->lastFeed.nextReadElevation;
+                if (!this->client->print("X-THINGSPEAKAPIKEY: ")) return false;
+                if (!this->client->print(APIKey)) return false;
+                if (!this->client->print("\r\n")) return false;
             }
             
+            return true;
+        }
+
+        // method and path of the request line, with the path prefix of the server in between
+        bool writeRequestLine(const char * method, const char * path)
+        {
+            if(!this->client->print(method)) return false;
+            if(this->pathPrefix[0] != 0 && !this->client->print(this->pathPrefix)) return false;
+            if(!this->client->print(path)) return false;
             
-            /*
-            Function: getCreatedAt
-             
-            Summary:
-            Fetch the created-at timestamp associated with the latest stored feed record.
+            return true;
+        }
+
+        bool writeHTTPGet(String & readURL, const char * APIKey)
+        {
+            if(!writeRequestLine("GET ", readURL.c_str())) return false;
+            if(!this->client->print(" HTTP/1.1\r\n")) return false;
+            if(!writeHTTPHeader(APIKey)) return false;
+            if(!this->client->print("\r\n")) return false;
             
-            Results:
-            Value read (UTF8 string). An empty string is returned if there was no created-at timestamp written to the channel or in case of an error.  Use getLastReadStatus() to get more specific information.
-            */
-            String getCreatedAt()
+            return true;
+        }
+
+        int getHTTPResponse(String & response)
+        {
+            int contentLength = 0;
+            int status = getHTTPResponseHeader(contentLength);
+            if(status != TS_OK_SUCCESS && status != TS_OK_ACCEPTED)
             {
-                return this->lastFeed.nextReadCreatedAt;
+                return status;
             }
+            
+            int bodyStatus = getHTTPResponseBody(response, contentLength);
+            return (bodyStatus == TS_OK_SUCCESS) ? status : bodyStatus;
+        }
         
-        #endif
-        
-     
-        /*
-        Function: getLastReadStatus
-        
-        Summary:
-        Get the status of the previous read.
-        
-        Returns:
-        Generally, these are HTTP status codes.  Negative values indicate an error generated by the library.
-        Possible response codes...
-        200 - OK / Success
-        404 - Incorrect API key (or invalid ThingSpeak server address)
-        -101 - Value is out of range or string is too long (> 255 characters)
-        -201 - Invalid field number specified
-        -210 - setField() was not called before writeFields()
-        -301 - Failed to connect to ThingSpeak
-        -302 -  Unexpected failure during write to ThingSpeak
-        -303 - Unable to parse response
-        -304 - Timeout waiting for server to respond
-        -401 - Point was not inserted (most probable cause is exceeding the rate limit)
-        
-        Notes:
-        The read functions will return zero or empty if there is an error.  Use this function to retrieve the details.
-        */
-        int getLastReadStatus()
+        // reads the body of a response whose header was read
+        int getHTTPResponseBody(String & response, int contentLength)
         {
-            return this->lastReadStatus;
+            String tempString = String("");
+            tempString.reserve(contentLength);
+            beginBody(contentLength);
+            for(int i = 0; i < contentLength; i++){
+                int y = readBodyChar();
+                if(y < 0){
+                    return TS_ERR_TIMEOUT;
+                }
+                tempString.concat((char)y);
+            }
+            response = tempString;
+            
+            #ifdef PRINT_HTTP
+                Serial.print("Response: \"");Serial.print(response);Serial.println("\"");
+            #endif
+            
+            return TS_OK_SUCCESS;
         }
         
-        
-    private:
+        int getHTTPResponseHeader(int & contentLength)
+        {
+            // make sure all of the HTTP request is pushed out of the buffer before looking for a response
+            this->client->flush();
+            this->responseBufferPos = 0;
+            this->responseBufferLength = 0;
             
-        int getWriteFieldsContentLength(){
-            size_t iField;
-            int contentLen = 0;
+            unsigned long timeoutTime = millis() + TIMEOUT_MS_SERVERRESPONSE;
             
-            for(iField = 0; iField < FIELDNUM_MAX; iField++){
-                if(this->nextWriteField[iField].length() > 0){
-                    contentLen = contentLen + 8 + this->nextWriteField[iField].length();	// &fieldX=[value]
-                    
-                    // future-proof in case ThingSpeak allows 999 fields someday
-                    if(iField > 9){
-                        contentLen = contentLen + 1;
-                    }
-                    else if(iField > 99){
-                        contentLen = contentLen + 2;
-                    }
-                    
+            while(this->client-> available() < 17){
+                if(this->client->available() > 0){
+                    this->responseStarted = true;
+                }
+                else if(!this->client->connected()){
+                    // closed without a response, no need to wait for the timeout
+                    return TS_ERR_TIMEOUT;
+                }
+                delay(2);
+                if(millis() > timeoutTime){
+                    return TS_ERR_TIMEOUT;
                 }
             }
+            this->responseStarted = true;
             
-            if(!isnan(this->nextWriteLatitude)){
-                contentLen = contentLen + 5 + String(this->nextWriteLatitude).length(); // &lat=[value]
+            if(!findInResponse("HTTP/1.1"))
+            {
+                #ifdef PRINT_HTTP
+                    Serial.println("ERROR: Didn't find HTTP/1.1");
+                #endif
+                return TS_ERR_BAD_RESPONSE; // Couldn't parse response (didn't find HTTP/1.1)
             }
             
-            if(!isnan(this->nextWriteLongitude)){
-                contentLen = contentLen + 6 + String(this->nextWriteLongitude).length(); // &long=[value]
+            int status = parseResponseInt();
+            #ifdef PRINT_HTTP
+                Serial.print("Got Status of ");Serial.println(status);
+            #endif
+            if(status != TS_OK_SUCCESS && status != TS_OK_ACCEPTED)
+            {
+                return status;
             }
-            
-            if(!isnan(this->nextWriteElevation)){
-                contentLen = contentLen + 11 + String(this->nextWriteElevation).length(); // &elevation=[value]
+
+            // Find Content-Length
+            if(!findInResponse("Content-Length:")){
+                #ifdef PRINT_HTTP
+                    Serial.println("ERROR: Didn't find Content-Length header");
+                #endif
+                return TS_ERR_BAD_RESPONSE; // Couldn't parse response (didn't find HTTP/1.1)
             }
+            contentLength = parseResponseInt();
             
-            if(this->nextWriteStatus.length() > 0){
-                contentLen = contentLen + 8 + this->nextWriteStatus.length();	// &status=[value]
-            }
+            #ifdef PRINT_HTTP
+                Serial.print("Content Length: ");
+                Serial.println(contentLength);
+            #endif
             
-            if(this->nextWriteCreatedAt.length() > 0){
-                contentLen = contentLen + 12 + this->nextWriteCreatedAt.length();	// &created_at=[value]
+            if(!findInResponse("\r\n\r\n"))
+            {
+                #ifdef PRINT_HTTP
+                    Serial.println("ERROR: Didn't find end of headers");
+                #endif
+                return TS_ERR_BAD_RESPONSE;
             }
+            #ifdef PRINT_HTTP
+                Serial.println("Found end of header");
+            #endif
             
-            if(contentLen == 0){
-                return 0;
+            return status;
+        }
+        
+        // Buffered access to the response, the client is read RESPONSEBUFFER_SIZE bytes at a time instead of byte by byte
+        int readResponseChar(int limit)
+        {
+            if(this->responseBufferPos < this->responseBufferLength)
+            {
+                return this->responseBuffer[this->responseBufferPos++];
+            }
+            if(limit <= 0)
+            {
+                return -1;
             }
             
-            contentLen = contentLen + 13; // add 14 for '&headers=false', subtract 1 for missing first '&'
-            
-            return contentLen;
+            unsigned long timeoutTime = millis() + TIMEOUT_MS_SERVERRESPONSE;
+            int count;
+            while((count = this->client->available()) <= 0){
+                if(!this->client->connected() || millis() > timeoutTime){
+                    return -1;
+                }
+                delay(2);
+            }
+            if(count > RESPONSEBUFFER_SIZE) count = RESPONSEBUFFER_SIZE;
+            if(count > limit) count = limit;
+            count = this->client->read(this->responseBuffer, count);
+            if(count <= 0)
+            {
+                return -1;
+            }
+            this->responseBufferLength = count;
+            this->responseBufferPos = 1;
+            return this->responseBuffer[0];
         }
         
-        void emptyStream(){
-            while(this->client->available() > 0){
-                this->client->read();
+        bool findInResponse(const char * target)
+        {
+            const char * match = target;
+            int c;
+            while(*match && (c = readResponseChar(RESPONSEBUFFER_SIZE)) >= 0)
+            {
+                if(c == *match)
+                {
+                    match++;
+                }
+                else
+                {
+                    match = (c == *target) ? target + 1 : target;
+                }
             }
+            return *match == 0;
         }
         
-        int finishWrite(){
-            String entryIDText = String();
-            int status = getHTTPResponse(entryIDText);
-            
-            emptyStream();
+        // same as Stream::parseInt(), skips to the first digit or '-' and leaves the character after the number unread
+        int parseResponseInt()
+        {
+            int c;
+            do
+            {
+                c = readResponseChar(RESPONSEBUFFER_SIZE);
+            } while(c >= 0 && c != '-' && (c < '0' || c > '9'));
             
-            if(status != TS_OK_SUCCESS)
+            bool negative = (c == '-');
+            if(negative)
             {
-                this->client->stop();
-                return status;
+                c = readResponseChar(RESPONSEBUFFER_SIZE);
             }
-            long entryID = entryIDText.toInt();
-
-            #ifdef PRINT_DEBUG_MESSAGES
-                Serial.print("               Entry ID \"");Serial.print(entryIDText);Serial.print("\" (");Serial.print(entryID);Serial.println(")");
-            #endif
-            
-            this->client->stop();
-            
-            #ifdef PRINT_DEBUG_MESSAGES
-                Serial.println("disconnected.");
-            #endif
-            if(entryID == 0)
+            long value = 0;
+            while(c >= '0' && c <= '9')
             {
-                // ThingSpeak did not accept the write
-                status = TS_ERR_NOT_INSERTED;
+                value = value * 10 + (c - '0');
+                c = readResponseChar(RESPONSEBUFFER_SIZE);
             }
-            
-            return status;
+            if(c >= 0)
+            {
+                // the character came from the buffer, so it can be put back
+                this->responseBufferPos--;
+            }
+            return negative ? -value : value;
         }
         
-        String getJSONValueByKey(String textToSearch, String key)
+        // Streaming access to a response body of known length, for responses too large to hold in a String
+        void beginBody(int contentLength)
         {
-            if(textToSearch.length() == 0){
-                return String("");
+            this->bodyRemaining = contentLength;
+            this->bodyPushback = -1;
+        }
+        
+        int readBodyChar()
+        {
+            if(this->bodyPushback >= 0)
+            {
+                int c = this->bodyPushback;
+                this->bodyPushback = -1;
+                return c;
             }
-            
-            String searchPhrase = String("\"");
-            searchPhrase.concat(key);
-            searchPhrase.concat("\":\"");
-            
-            int fromPosition = textToSearch.indexOf(searchPhrase,0);
-            
-            if(fromPosition == -1){
-                // return because there is no status or it's null
-                return String("");
+            if(this->bodyRemaining <= 0)
+            {
+                return -1;
             }
             
-            fromPosition = fromPosition + searchPhrase.length();
-                    
-            int toPosition = textToSearch.indexOf("\"", fromPosition);
-            
-            
-            if(toPosition == -1){
-                // return because there is no end quote
-                return String("");
+            // never take more than the body from the client, a kept-alive connection carries the next response after it
+            int c = readResponseChar(this->bodyRemaining);
+            if(c >= 0)
+            {
+                this->bodyRemaining--;
             }
-            
-            textToSearch.remove(toPosition);
-            
-            return textToSearch.substring(fromPosition);
+            return c;
         }
         
-        #ifndef ARDUINO_AVR_UNO
-            String parseValues(String & multiContent, String key)
+        void unreadBodyChar(int c)
+        {
+            this->bodyPushback = c;
+        }
+        
+        bool findInBody(const char * target)
+        {
+            const char * match = target;
+            int c;
+            while(*match && (c = readBodyChar()) >= 0)
             {
-                if(multiContent.length() == 0){
-                    return String("");
+                if(c == *match)
+                {
+                    match++;
                 }
-                
-                String searchPhrase = String("\"");
-                searchPhrase.concat(key);
-                searchPhrase.concat("\":\"");
-                
-                int fromPosition = multiContent.indexOf(searchPhrase,0);
-                
-                if(fromPosition == -1){
-                    // return because there is no status or it's null
-                    return String("");
+                else
+                {
+                    match = (c == *target) ? target + 1 : target;
                 }
-                
-                fromPosition = fromPosition + searchPhrase.length();
-                        
-                int toPosition = multiContent.indexOf("\"", fromPosition);
-                
-                
-                if(toPosition == -1){
-                    // return because there is no end quote
-                    return String("");
+            }
+            return *match == 0;
+        }
+        
+        int readBodyNonSpace()
+        {
+            int c;
+            do
+            {
+                c = readBodyChar();
+            } while(c == ' ' || c == '\r' || c == '\n' || c == '\t');
+            return c;
+        }
+        
+        // reads a JSON string after its opening quote, keeping as much as fits into value
+        bool readJSONString(char * value, size_t valueSize)
+        {
+            size_t len = 0;
+            int c;
+            while((c = readBodyChar()) >= 0)
+            {
+                if(c == '"')
+                {
+                    value[len] = 0;
+                    return true;
+                }
+                if(c == '\\')
+                {
+                    c = readBodyChar();
+                    if(c < 0) break;
+                }
+                if(len + 1 < valueSize)
+                {
+                    value[len++] = (char)c;
                 }
-                
-                return multiContent.substring(fromPosition, toPosition);
             }
-        #endif
+            value[len] = 0;
+            return false;
+        }
         
-        int abortWriteRaw()
+        // reads a JSON string, number or literal, keeping as much as fits into value
+        bool readJSONValue(char * value, size_t valueSize)
         {
-            while(this->client->available() > 0){
-                this->client->read();
+            int c = readBodyNonSpace();
+            if(c == '"')
+            {
+                return readJSONString(value, valueSize);
             }
-            this->client->stop();
-            resetWriteFields();
-            
-            return TS_ERR_UNEXPECTED_FAIL;
-        }
-
-        String abortReadRaw()
-        {
-            while(this->client->available() > 0){
-                this->client->read();
+            size_t len = 0;
+            while(c >= 0 && c != ',' && c != '}' && c != ']')
+            {
+                if(len + 1 < valueSize && c != ' ')
+                {
+                    value[len++] = (char)c;
+                }
+                c = readBodyChar();
             }
-            this->client->stop();
-            #ifdef PRINT_DEBUG_MESSAGES
-                Serial.println("ReadRaw abort - disconnected.");
-            #endif
-            this->lastReadStatus = TS_ERR_UNEXPECTED_FAIL;
-            return String("");
+            value[len] = 0;
+            if(c < 0)
+            {
+                return false;
+            }
+            unreadBodyChar(c);
+            return true;
         }
-
-        void setPort(unsigned int port)
+        
+        int parseFeedJSON(feedColumns & columns)
         {
-            this->port = port;
+            // skip the channel description, it has field keys of its own
+            if(!findInBody("\"feeds\":["))
+            {
+                return TS_ERR_BAD_RESPONSE;
+            }
+            
+            char key[12];
+            char value[FEEDVALUE_MAX];
+            int c;
+            while((c = readBodyNonSpace()) >= 0)
+            {
+                if(c == ',') continue;
+                if(c == ']') return TS_OK_SUCCESS;
+                if(c != '{') return TS_ERR_BAD_RESPONSE;
+                
+                if(columns.count >= columns.capacity)
+                {
+                    // more updates than room, keep what we have
+                    return TS_OK_SUCCESS;
+                }
+                unsigned int row = columns.count;
+                initFeedColumnsRow(columns, row);
+                
+                while((c = readBodyNonSpace()) != '}')
+                {
+                    if(c == ',') continue;
+                    if(c != '"' || !readJSONString(key, sizeof(key))) return TS_ERR_BAD_RESPONSE;
+                    if(readBodyNonSpace() != ':') return TS_ERR_BAD_RESPONSE;
+                    if(!readJSONValue(value, sizeof(value))) return TS_ERR_BAD_RESPONSE;
+                    storeFeedColumnsValue(columns, row, key, value);
+                }
+                columns.count++;
+            }
+            return TS_ERR_BAD_RESPONSE;
         }
         
-        void setClient(Client * client)
+        // skips a JSON object or array after its opening bracket
+        bool skipJSONContainer()
         {
-            this->client = client;
-            
+            int depth = 1;
+            int c;
+            while(depth > 0 && (c = readBodyChar()) >= 0)
+            {
+                if(c == '"')
+                {
+                    char ignored[1];
+                    if(!readJSONString(ignored, sizeof(ignored))) return false;
+                }
+                else if(c == '{' || c == '[')
+                {
+                    depth++;
+                }
+                else if(c == '}' || c == ']')
+                {
+                    depth--;
+                }
+            }
+            return depth == 0;
         }
         
-        Client * client = NULL;
-        unsigned int port = THINGSPEAK_PORT_NUMBER;
-        String nextWriteField[8];
-        float nextWriteLatitude;
-        float nextWriteLongitude;
-        float nextWriteElevation;
-        int lastReadStatus;
-        String nextWriteStatus;
-        String nextWriteCreatedAt;
-        #ifndef ARDUINO_AVR_UNO
-            feed lastFeed;
-        #endif
-
-        bool connectThingSpeak()
+        int parseChannelJSON(channelInfo & info)
         {
-            bool connectSuccess = false;
+            if(!findInBody("\"channel\":") || readBodyNonSpace() != '{')
+            {
+                return TS_ERR_BAD_RESPONSE;
+            }
             
-            #ifdef PRINT_DEBUG_MESSAGES
-                Serial.print("               Connect to default ThingSpeak: ");
-                Serial.print(THINGSPEAK_URL);
-                Serial.print(":");
-                Serial.print(this->port);
-                Serial.print("...");
-            #endif
-                    
-            connectSuccess = client->connect(const_cast<char *>(THINGSPEAK_URL), this->port);
+            memset(&info, 0, sizeof(info));
+            char key[16];
+            char value[CHANNELINFO_NAME_MAX];
+            int c;
+            while((c = readBodyNonSpace()) != '}')
+            {
+                if(c == ',') continue;
+                if(c != '"' || !readJSONString(key, sizeof(key))) return TS_ERR_BAD_RESPONSE;
+                if(readBodyNonSpace() != ':') return TS_ERR_BAD_RESPONSE;
                 
-            #ifdef PRINT_DEBUG_MESSAGES
-                if (connectSuccess)
+                c = readBodyNonSpace();
+                if(c == '{' || c == '[')
                 {
-                    Serial.println("Success.");
+                    // nested metadata this record has no room for
+                    if(!skipJSONContainer()) return TS_ERR_BAD_RESPONSE;
+                    continue;
                 }
-                else
+                unreadBodyChar(c);
+                if(!readJSONValue(value, sizeof(value))) return TS_ERR_BAD_RESPONSE;
+                
+                if(0 == strncmp(key, "field", 5) && key[5] >= '1' && key[5] <= '8' && key[6] == 0)
                 {
-                    Serial.println("Failed.");
+                    unsigned int iField = key[5] - '1';
+                    strncpy(info.fieldLabel[iField], value, CHANNELINFO_LABEL_MAX - 1);
+                    info.fieldLabel[iField][CHANNELINFO_LABEL_MAX - 1] = 0;
+                    info.activeFields |= (1 << iField);
                 }
-            #endif
-            
-            return connectSuccess;
+                else if(0 == strcmp(key, "name"))
+                {
+                    strcpy(info.name, value);
+                }
+                else if(0 == strcmp(key, "id"))
+                {
+                    info.channelNumber = strtoul(value, NULL, 10);
+                }
+                else if(0 == strcmp(key, "updated_at"))
+                {
+                    info.updatedAt = convertTimestampToEpoch(value);
+                }
+                else if(0 == strcmp(key, "last_entry_id"))
+                {
+                    info.lastEntryID = strtoul(value, NULL, 10);
+                }
+            }
+            return TS_OK_SUCCESS;
         }
-
-        bool writeHTTPHeader(const char * APIKey)
+        
+        // reads one CSV cell, handling quoted cells with "" escapes, and returns the character that ended it: ',', '\n' or -1
+        int readCSVCell(char * value, size_t valueSize)
         {
-     
-            if (!this->client->print("Host: api.thingspeak.com\r\n")) return false;
-            if (!this->client->print("User-Agent: ")) return false;
-            if (!this->client->print(TS_USER_AGENT)) return false;
-            if (!this->client->print("\r\n")) return false;
-            if(NULL != APIKey)
+            size_t len = 0;
+            bool quoted = false;
+            int c = readBodyChar();
+            if(c == '"')
             {
-                if (!this->client->print("X-THINGSPEAKAPIKEY: ")) return false;
-                if (!this->client->print(APIKey)) return false;
-                if (!this->client->print("\r\n")) return false;
+                quoted = true;
+                c = readBodyChar();
             }
-            
-            return true;
+            while(c >= 0)
+            {
+                if(quoted && c == '"')
+                {
+                    c = readBodyChar();
+                    if(c != '"')
+                    {
+                        // closing quote
+                        quoted = false;
+                        continue;
+                    }
+                }
+                else if(!quoted && (c == ',' || c == '\n'))
+                {
+                    break;
+                }
+                if(c != '\r' && len + 1 < valueSize)
+                {
+                    value[len++] = (char)c;
+                }
+                c = readBodyChar();
+            }
+            value[len] = 0;
+            return c;
         }
-
-        int getHTTPResponse(String & response)
+        
+        int parseFeedCSV(feedColumns & columns)
         {
-            // make sure all of the HTTP request is pushed out of the buffer before looking for a response
-            this->client->flush();
+            // map the header once, every update uses the same column order
+            char cell[FEEDVALUE_MAX];
+            char columnKeys[FEEDCOLUMNS_MAX][12];
+            unsigned int numColumns = 0;
+            int terminator;
+            do
+            {
+                terminator = readCSVCell(cell, sizeof(cell));
+                if(numColumns < FEEDCOLUMNS_MAX)
+                {
+                    size_t n = strlen(cell);
+                    if(n >= sizeof(columnKeys[0])) n = sizeof(columnKeys[0]) - 1;
+                    memcpy(columnKeys[numColumns], cell, n);
+                    columnKeys[numColumns][n] = '\0';
+                    numColumns++;
+                }
+            } while(terminator == ',');
             
-            unsigned long timeoutTime = millis() + TIMEOUT_MS_SERVERRESPONSE;
+            if(terminator < 0 || 0 != strcmp(columnKeys[0], "created_at"))
+            {
+                return TS_ERR_BAD_RESPONSE;
+            }
             
-            while(this->client-> available() < 17){
-                delay(2);
-                if(millis() > timeoutTime){
-                    return TS_ERR_TIMEOUT;
+            while(columns.count < columns.capacity)
+            {
+                unsigned int row = columns.count;
+                unsigned int column = 0;
+                initFeedColumnsRow(columns, row);
+                do
+                {
+                    terminator = readCSVCell(cell, sizeof(cell));
+                    if(column < numColumns)
+                    {
+                        storeFeedColumnsValue(columns, row, columnKeys[column], cell);
+                    }
+                    column++;
+                } while(terminator == ',');
+                
+                if(column == 1 && cell[0] == 0)
+                {
+                    // empty line or end of the response
+                    if(terminator < 0) break;
+                    continue;
                 }
+                columns.count++;
+                if(terminator < 0) break;
             }
             
-            if(!this->client->find(const_cast<char *>("HTTP/1.1")))
+            return TS_OK_SUCCESS;
+        }
+        
+        void initFeedColumnsRow(feedColumns & columns, unsigned int row)
+        {
+            if(NULL != columns.createdAt) columns.createdAt[row] = 0;
+            if(NULL != columns.entryID) columns.entryID[row] = 0;
+            for(size_t iField = 0; iField < FIELDNUM_MAX; iField++)
             {
-                #ifdef PRINT_HTTP
-                    Serial.println("ERROR: Didn't find HTTP/1.1");
-                #endif
-                return TS_ERR_BAD_RESPONSE; // Couldn't parse response (didn't find HTTP/1.1)
+                if(NULL != columns.field[iField]) columns.field[iField][row] = NAN;
             }
-            
-            int status = this->client->parseInt();
-            #ifdef PRINT_HTTP
-                Serial.print("Got Status of ");Serial.println(status);
-            #endif
-            if(status != TS_OK_SUCCESS)
+        }
+        
+        void storeFeedColumnsValue(feedColumns & columns, unsigned int row, const char * key, const char * value)
+        {
+            if(0 == strncmp(key, "field", 5) && key[5] >= '1' && key[5] <= '8' && key[6] == 0)
             {
-                return status;
+                float * column = columns.field[key[5] - '1'];
+                if(NULL != column)
+                {
+                    column[row] = convertCharToFloat(value);
+                }
             }
-
-            // Find Content-Length
-            if(!this->client->find(const_cast<char *>("Content-Length:"))){
-                #ifdef PRINT_HTTP
-                    Serial.println("ERROR: Didn't find Content-Length header");
-                #endif
-                return TS_ERR_BAD_RESPONSE; // Couldn't parse response (didn't find HTTP/1.1)
+            else if(0 == strcmp(key, "created_at"))
+            {
+                if(NULL != columns.createdAt) columns.createdAt[row] = convertTimestampToEpoch(value);
             }
-            int contentLength = this->client->parseInt();
-            
-            #ifdef PRINT_HTTP
-                Serial.print("Content Length: ");
-                Serial.println(contentLength);
-            #endif
-            
-            if(!this->client->find(const_cast<char *>("\r\n\r\n")))
+            else if(0 == strcmp(key, "entry_id"))
             {
-                #ifdef PRINT_HTTP
-                    Serial.println("ERROR: Didn't find end of headers");
-                #endif
-                return TS_ERR_BAD_RESPONSE;
+                if(NULL != columns.entryID) columns.entryID[row] = strtoul(value, NULL, 10);
             }
-            #ifdef PRINT_HTTP
-                Serial.println("Found end of header");
+        }
+        
+        // info, when given, gets the channel description of a JSON feed
+        int readFeed(unsigned long channelNumber, String & suffixURL, feedColumns & columns, const char * readAPIKey, channelInfo * info = NULL)
+        {
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("ts::readFeed   (channelNumber: "); Serial.print(channelNumber);
+                Serial.print(" suffixURL: \""); Serial.print(suffixURL); Serial.println("\")");
             #endif
             
-            timeoutTime = millis() + TIMEOUT_MS_SERVERRESPONSE;
+            columns.count = 0;
             
-            while(this->client->available() < contentLength){
-                delay(2);
-                if(millis() > timeoutTime){
-                    return TS_ERR_TIMEOUT;
-                }
-            }
+            String readURL = String("/channels/");
+            readURL.concat(channelNumber);
+            readURL.concat(suffixURL);
             
-            String tempString = String("");
-            char y = 0;
-            for(int i = 0; i < contentLength; i++){
-                y = client->read();
-                tempString.concat(y);
+            int contentLength = 0;
+            int status = requestRead(readURL, readAPIKey, contentLength);
+            if(status == TS_OK_SUCCESS)
+            {
+                beginBody(contentLength);
+                if(NULL != info)
+                {
+                    status = parseChannelJSON(*info);
+                }
+                if(status == TS_OK_SUCCESS)
+                {
+                    status = (NULL == info && this->feedFormat == TS_FEED_FORMAT_CSV) ? parseFeedCSV(columns) : parseFeedJSON(columns);
+                }
             }
-            response = tempString;
+            this->lastReadStatus = status;
             
-            #ifdef PRINT_HTTP
-                Serial.print("Response: \"");Serial.print(response);Serial.println("\"");
+            emptyStream();
+            // an unread rest of the body would be taken for the next response, so such a connection can't be kept
+            finishConnection((this->bodyRemaining > 0) ? TS_ERR_UNEXPECTED_FAIL : status);
+            #ifdef PRINT_DEBUG_MESSAGES
+                Serial.print("Read "); Serial.print(columns.count); Serial.println(" updates.");
             #endif
             
             return status;
@@ -1648,17 +5618,152 @@
             return result;
         }
 
+        float convertCharToFloat(const char * value)
+        {
+            // missing ("null" or empty) and text values become NAN, so they can't be mistaken for a 0 reading
+            char * end;
+            float result = strtod(value, &end);
+            if(end == value)
+            {
+                return NAN;
+            }
+            return result;
+        }
+
+        // "YYYY-MM-DD%20HH:NN:SS" as taken by the start and end parameters of a feed
+        void appendTimestamp(String & text, uint32_t epoch)
+        {
+            // civil date of the proleptic Gregorian calendar, from days since 1970-01-01
+            long days = epoch / 86400L + 719468L;
+            long era = days / 146097L;
+            long dayOfEra = days - era * 146097L;
+            long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+            long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+            long monthIndex = (5 * dayOfYear + 2) / 153;
+            int day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+            int month = (monthIndex < 10) ? monthIndex + 3 : monthIndex - 9;
+            long year = yearOfEra + era * 400 + ((month <= 2) ? 1 : 0);
+            long seconds = epoch % 86400L;
+            
+            char timestamp[36];
+            sprintf(timestamp, "%04ld-%02d-%02d%%20%02ld:%02ld:%02ld", year, month, day, seconds / 3600, (seconds / 60) % 60, seconds % 60);
+            text.concat(timestamp);
+        }
+        
+        void printMirrorEntry(Print & store, feedColumns & page, unsigned int row)
+        {
+            store.print((unsigned long)page.entryID[row]);
+            store.print(",");
+            store.print((unsigned long)page.createdAt[row]);
+            for(size_t iField = 0; iField < FIELDNUM_MAX; iField++)
+            {
+                store.print(",");
+                if(NULL != page.field[iField])
+                {
+                    printBulkValue(store, page.field[iField][row]);
+                }
+            }
+            store.print("\n");
+        }
+        
+        uint32_t convertTimestampToEpoch(const char * timestamp)
+        {
+            // ISO 8601 as sent by ThingSpeak, "2017-01-12T13:22:54Z" or with an offset like "2017-01-12T13:22:54-05:00", "-0500" or "-05";
+            // returns 0 for a timestamp that cannot be read
+            if(strlen(timestamp) < 19)
+            {
+                return 0;
+            }
+            long year = atol(timestamp);
+            int month = atoi(timestamp + 5);
+            int day = atoi(timestamp + 8);
+            long seconds = atol(timestamp + 11) * 3600L + atol(timestamp + 14) * 60L + atol(timestamp + 17);
+            
+            const char * zone = timestamp + 19;
+            if(*zone == '+' || *zone == '-')
+            {
+                // two digits of hours, then optionally two digits of minutes with or without a colon
+                const char * minutes = (zone[3] == ':') ? zone + 4 : zone + 3;
+                if(!isdigit(zone[1]) || !isdigit(zone[2]))
+                {
+                    return 0;
+                }
+                long offset = ((zone[1] - '0') * 10 + (zone[2] - '0')) * 3600L;
+                if(minutes[0] != 0 || minutes != zone + 3)
+                {
+                    if(!isdigit(minutes[0]) || !isdigit(minutes[1]) || minutes[2] != 0 || minutes[0] > '5')
+                    {
+                        return 0;
+                    }
+                    offset += ((minutes[0] - '0') * 10 + (minutes[1] - '0')) * 60L;
+                }
+                seconds += (*zone == '+') ? -offset : offset;
+            }
+            else if(*zone != 0 && 0 != strcmp(zone, "Z") && 0 != strcmp(zone, " UTC"))
+            {
+                return 0;
+            }
+            
+            // days since 1970-01-01 of the proleptic Gregorian calendar
+            if(month <= 2)
+            {
+                year--;
+                month += 12;
+            }
+            long days = 365L * year + year / 4 - year / 100 + year / 400 + (153L * (month - 3) + 2) / 5 + day - 719469L;
+            
+            return (uint32_t)(days * 86400L + seconds);
+        }
+
         void resetWriteFields()
+        {
+            lockStaging();
+            clearStagedWrite(nextWrite());
+            unlockStaging();
+        }
+        
+        // the set functions may run in another FreeRTOS task than the functions that take the staged values, possibly on the other core,
+        // so on an ESP32 a set function finishes before the slots are switched, and never writes into a slot that is being sent
+        void lockStaging()
+        {
+            #if defined(ARDUINO_ARCH_ESP32)
+                xSemaphoreTake(this->stagingLock, portMAX_DELAY);
+            #endif
+        }
+        
+        void unlockStaging()
+        {
+            #if defined(ARDUINO_ARCH_ESP32)
+                xSemaphoreGive(this->stagingLock);
+            #endif
+        }
+        
+        writeStaging & nextWrite()
+        {
+            return this->stagedWrites[this->nextWriteSlot];
+        }
+        
+        // hands the staged values to the caller and switches the set functions to the other slot, which the last write cleared
+        writeStaging & takeStagedWrite()
+        {
+            lockStaging();
+            uint8_t slot = this->nextWriteSlot;
+            this->nextWriteSlot = (0 == slot) ? 1 : 0;
+            unlockStaging();
+            return this->stagedWrites[slot];
+        }
+        
+        void clearStagedWrite(writeStaging & staged)
         {
             for(size_t iField = 0; iField < FIELDNUM_MAX; iField++)
             {
-                this->nextWriteField[iField] = "";
+                staged.field[iField] = "";
             }
-            this->nextWriteLatitude = NAN;
-            this->nextWriteLongitude = NAN;
-            this->nextWriteElevation = NAN;
-            this->nextWriteStatus = "";
-            this->nextWriteCreatedAt = "";
+            staged.latitude = NAN;
+            staged.longitude = NAN;
+            staged.elevation = NAN;
+            staged.status = "";
+            staged.createdAt = "";
         }
     };
 
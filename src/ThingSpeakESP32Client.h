@@ -0,0 +1,359 @@
+/*
+  ThingSpeakESP32Client
+
+  Client for ESP32 boards that talks to ESP-IDF's esp-tls directly, instead of going through
+  WiFiClient or WiFiClientSecure.  Pass it to ThingSpeak.begin() like any other client.
+
+  - HTTPS when connecting to port 443, plain TCP otherwise
+  - TLS sessions are resumed on reconnect when the core enables CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS,
+    which saves most of the handshake
+  - data is received into a buffer of TS_ESP32_CLIENT_BUFFER_SIZE bytes, so byte reads don't each
+    go down to mbedTLS
+  - connected() notices a connection closed by the server, so kept-alive connections
+    (ThingSpeak.setKeepAlive(true)) are not reused after the server dropped them
+
+  The server certificate is checked against the certificate set with setCACert(), or against the
+  ESP-IDF certificate bundle when the core includes it.
+
+  Copyright 2020-2025, The MathWorks, Inc.
+
+  See the accompanying license file for licensing information.
+*/
+
+#ifndef ThingSpeakESP32Client_h
+    #define ThingSpeakESP32Client_h
+
+    #if !defined(ARDUINO_ARCH_ESP32)
+        #error "ThingSpeakESP32Client is only available for ESP32 boards"
+    #endif
+
+    #include <Arduino.h>
+    #include <Client.h>
+    #include "esp_tls.h"
+    #if defined(CONFIG_MBEDTLS_CERTIFICATE_BUNDLE)
+        #include "esp_crt_bundle.h"
+    #endif
+    #include "lwip/sockets.h"
+    #include <errno.h>
+
+    #ifndef TS_ESP32_CLIENT_BUFFER_SIZE
+        #define TS_ESP32_CLIENT_BUFFER_SIZE 512
+    #endif
+    #define TS_ESP32_CLIENT_TIMEOUT_MS 5000
+
+    class ThingSpeakESP32Client : public Client
+    {
+        public:
+            ThingSpeakESP32Client()
+            {
+                this->tls = NULL;
+                this->caCert = NULL;
+                this->timeoutMS = TS_ESP32_CLIENT_TIMEOUT_MS;
+                this->closed = true;
+                this->secure = false;
+                this->bufferPos = 0;
+                this->bufferLength = 0;
+                #ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+                    this->session = NULL;
+                #endif
+            }
+
+            ~ThingSpeakESP32Client()
+            {
+                stop();
+                #ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+                    if(NULL != this->session)
+                    {
+                        esp_tls_free_client_session(this->session);
+                    }
+                #endif
+            }
+
+            // PEM certificate of the root CA of the server, must stay valid while the client is used
+            void setCACert(const char * rootCA)
+            {
+                this->caCert = rootCA;
+            }
+
+            void setConnectionTimeout(uint32_t timeoutMS)
+            {
+                this->timeoutMS = timeoutMS;
+            }
+
+            int connect(IPAddress ip, uint16_t port)
+            {
+                return connect(ip.toString().c_str(), port);
+            }
+
+            int connect(IPAddress ip, uint16_t port, int32_t timeout)
+            {
+                this->timeoutMS = timeout;
+                return connect(ip, port);
+            }
+
+            int connect(const char * host, uint16_t port, int32_t timeout)
+            {
+                this->timeoutMS = timeout;
+                return connect(host, port);
+            }
+
+            int connect(const char * host, uint16_t port)
+            {
+                stop();
+
+                esp_tls_cfg_t cfg = {};
+                cfg.timeout_ms = this->timeoutMS;
+                if(port != 443)
+                {
+                    cfg.is_plain_tcp = true;
+                }
+                else if(NULL != this->caCert)
+                {
+                    cfg.cacert_pem_buf = (const unsigned char *)this->caCert;
+                    cfg.cacert_pem_bytes = strlen(this->caCert) + 1;
+                }
+                #if defined(CONFIG_MBEDTLS_CERTIFICATE_BUNDLE)
+                    else
+                    {
+                        cfg.crt_bundle_attach = esp_crt_bundle_attach;
+                    }
+                #endif
+                #ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+                    cfg.client_session = this->session;
+                #endif
+
+                this->tls = esp_tls_init();
+                if(NULL == this->tls)
+                {
+                    return 0;
+                }
+                if(esp_tls_conn_new_sync(host, strlen(host), port, &cfg, this->tls) != 1)
+                {
+                    esp_tls_conn_destroy(this->tls);
+                    this->tls = NULL;
+                    return 0;
+                }
+                this->closed = false;
+                this->secure = (port == 443);
+
+                #ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+                    if(port == 443)
+                    {
+                        // keep the newest ticket for the next handshake
+                        esp_tls_client_session_t * newSession = esp_tls_get_client_session(this->tls);
+                        if(NULL != newSession)
+                        {
+                            if(NULL != this->session)
+                            {
+                                esp_tls_free_client_session(this->session);
+                            }
+                            this->session = newSession;
+                        }
+                    }
+                #endif
+                return 1;
+            }
+
+            size_t write(uint8_t c)
+            {
+                return write(&c, 1);
+            }
+
+            size_t write(const uint8_t * buf, size_t size)
+            {
+                if(NULL == this->tls || this->closed)
+                {
+                    return 0;
+                }
+                size_t written = 0;
+                while(written < size)
+                {
+                    ssize_t count = esp_tls_conn_write(this->tls, buf + written, size - written);
+                    if(count > 0)
+                    {
+                        written += count;
+                    }
+                    else if(count != ESP_TLS_ERR_SSL_WANT_READ && count != ESP_TLS_ERR_SSL_WANT_WRITE)
+                    {
+                        this->closed = true;
+                        break;
+                    }
+                }
+                return written;
+            }
+
+            int available()
+            {
+                if(this->bufferPos >= this->bufferLength)
+                {
+                    fillBuffer();
+                    return this->bufferLength - this->bufferPos;
+                }
+                // more may have arrived behind the buffered bytes
+                return (this->bufferLength - this->bufferPos) + pendingBytes();
+            }
+
+            int read()
+            {
+                if(available() <= 0)
+                {
+                    return -1;
+                }
+                return this->buffer[this->bufferPos++];
+            }
+
+            int read(uint8_t * buf, size_t size)
+            {
+                // only what is in the buffer, available() also counts bytes still waiting in the TLS layer
+                if(this->bufferPos >= this->bufferLength)
+                {
+                    fillBuffer();
+                }
+                int count = this->bufferLength - this->bufferPos;
+                if(count <= 0)
+                {
+                    return -1;
+                }
+                if((size_t)count > size)
+                {
+                    count = size;
+                }
+                memcpy(buf, this->buffer + this->bufferPos, count);
+                this->bufferPos += count;
+                return count;
+            }
+
+            int peek()
+            {
+                if(available() <= 0)
+                {
+                    return -1;
+                }
+                return this->buffer[this->bufferPos];
+            }
+
+            void flush()
+            {
+                // esp-tls writes synchronously, there is nothing to push out
+            }
+
+            void stop()
+            {
+                if(NULL != this->tls)
+                {
+                    esp_tls_conn_destroy(this->tls);
+                    this->tls = NULL;
+                }
+                this->closed = true;
+                this->secure = false;
+                this->bufferPos = 0;
+                this->bufferLength = 0;
+            }
+
+            uint8_t connected()
+            {
+                if(this->bufferPos < this->bufferLength)
+                {
+                    return 1;
+                }
+                if(NULL == this->tls || this->closed)
+                {
+                    return 0;
+                }
+                // a readable socket that has no data is one the server closed
+                int sockfd = -1;
+                if(esp_tls_get_conn_sockfd(this->tls, &sockfd) == ESP_OK && sockfd >= 0)
+                {
+                    uint8_t probe;
+                    int count = recv(sockfd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+                    if(count == 0 || (count < 0 && errno != EWOULDBLOCK && errno != EAGAIN))
+                    {
+                        this->closed = true;
+                    }
+                }
+                return !this->closed;
+            }
+
+            operator bool()
+            {
+                return connected();
+            }
+
+        private:
+            esp_tls_t * tls;
+            const char * caCert;
+            uint32_t timeoutMS;
+            bool closed;
+            bool secure;
+            uint8_t buffer[TS_ESP32_CLIENT_BUFFER_SIZE];
+            size_t bufferPos;
+            size_t bufferLength;
+            #ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+                esp_tls_client_session_t * session;
+            #endif
+
+            // bytes received but not in the buffer yet, decrypted ones for TLS or unread ones on the socket
+            int pendingBytes()
+            {
+                if(NULL == this->tls || this->closed)
+                {
+                    return 0;
+                }
+                if(this->secure)
+                {
+                    ssize_t count = esp_tls_get_bytes_avail(this->tls);
+                    return (count > 0) ? count : 0;
+                }
+                int sockfd = -1;
+                int count = 0;
+                if(esp_tls_get_conn_sockfd(this->tls, &sockfd) != ESP_OK || sockfd < 0 || ioctl(sockfd, FIONREAD, &count) < 0)
+                {
+                    return 0;
+                }
+                return count;
+            }
+
+            // takes what has arrived without waiting for more
+            void fillBuffer()
+            {
+                this->bufferPos = 0;
+                this->bufferLength = 0;
+                if(NULL == this->tls || this->closed)
+                {
+                    return;
+                }
+
+                // mbedTLS may hold decrypted data already, otherwise only read when the socket has something
+                if(esp_tls_get_bytes_avail(this->tls) <= 0)
+                {
+                    int sockfd = -1;
+                    if(esp_tls_get_conn_sockfd(this->tls, &sockfd) != ESP_OK || sockfd < 0)
+                    {
+                        return;
+                    }
+                    uint8_t probe;
+                    int count = recv(sockfd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+                    if(count == 0)
+                    {
+                        this->closed = true;
+                        return;
+                    }
+                    if(count < 0)
+                    {
+                        return;
+                    }
+                }
+
+                ssize_t count = esp_tls_conn_read(this->tls, this->buffer, sizeof(this->buffer));
+                if(count > 0)
+                {
+                    this->bufferLength = count;
+                }
+                else if(count == 0 || (count != ESP_TLS_ERR_SSL_WANT_READ && count != ESP_TLS_ERR_SSL_WANT_WRITE))
+                {
+                    this->closed = true;
+                }
+            }
+    };
+
+#endif
@@ -0,0 +1,155 @@
+/*
+  ThingSpeakRelay
+
+  Request handling of a relay that takes the updates of devices on the local network, see the Relay
+  example for ESP32.  relayHandleRequest() takes one update request, as sent by writeField() and
+  writeFields() of this library, queues its fields on the gateway channel that has the write API key
+  of the request, and acknowledges it right away.  ThingSpeak.serviceGateway() sends the queued
+  updates of each channel to ThingSpeak later, many updates in one bulk update.
+
+  Works with any Client the device connected with, like the WiFiClient returned by WiFiServer.
+
+  Copyright 2020-2025, The MathWorks, Inc.
+
+  See the accompanying license file for licensing information.
+*/
+
+#ifndef ThingSpeakRelay_h
+    #define ThingSpeakRelay_h
+
+    #include "ThingSpeak.h"
+
+    #define RELAY_TIMEOUT_MS 1000   // Longest wait for the next part of a request from a device
+    #define RELAY_KEY_MAX 24        // Longest write API key that is accepted, including terminator
+
+    // number of updates accepted since the relay started, sent back as the entry ID
+    inline unsigned long relayNextReceipt()
+    {
+        static unsigned long receipt = 0;
+        return ++receipt;
+    }
+
+    // gateway channel with the given write API key, or NULL
+    inline gatewayChannel * relayFindChannel(gatewayChannel * channels, unsigned int numChannels, const char * writeAPIKey)
+    {
+        for(unsigned int i = 0; i < numChannels; i++)
+        {
+            if(0 == strcmp(channels[i].writeAPIKey, writeAPIKey))
+            {
+                return &channels[i];
+            }
+        }
+        return NULL;
+    }
+
+    inline void relayRespond(Client & device, int status, unsigned long entryID)
+    {
+        String body = String(entryID);
+        device.print("HTTP/1.1 ");
+        device.print(status);
+        device.print((status == TS_OK_SUCCESS) ? " OK\r\n" : (status == TS_ERR_BADURL) ? " Not Found\r\n" : " Bad Request\r\n");
+        device.print("Content-Type: text/plain\r\nConnection: close\r\nContent-Length: ");
+        device.print(body.length());
+        device.print("\r\n\r\n");
+        device.print(body);
+    }
+
+    /*
+      Reads one update request from a device and queues its fields.  Returns 200 when the update was
+      queued, 404 when the request is not an update, 400 when its key belongs to none of the channels,
+      or the status of queueChannelFields() when the update was not queued, like -210 when it has no
+      numeric field.  The device gets 200 with the receipt number as entry ID for a queued update, so
+      writeField() and writeFields() on the device return 200, and 200 with entry ID 0 for an update
+      that was not queued, as ThingSpeak answers an update it did not accept, so they return -401.
+      Other requests get 404 or 400.
+    */
+    inline int relayHandleRequest(Client & device, gatewayChannel * channels, unsigned int numChannels)
+    {
+        device.setTimeout(RELAY_TIMEOUT_MS);
+
+        // request line, then the headers up to the blank line
+        String line = device.readStringUntil('\n');
+        bool isUpdate = line.startsWith("POST ") && line.indexOf("/update ") > 0;
+        char writeAPIKey[RELAY_KEY_MAX] = "";
+        long contentLength = 0;
+        while(true)
+        {
+            line = device.readStringUntil('\n');
+            line.trim();
+            if(line.length() == 0)
+            {
+                break;
+            }
+            if(line.startsWith("X-THINGSPEAKAPIKEY: "))
+            {
+                line.substring(20).toCharArray(writeAPIKey, RELAY_KEY_MAX);
+            }
+            else if(line.startsWith("Content-Length: "))
+            {
+                contentLength = line.substring(16).toInt();
+            }
+        }
+
+        // body of name=value pairs, the key may also be given as api_key
+        String body = String();
+        body.reserve(contentLength);
+        while((long)body.length() < contentLength)
+        {
+            int c = device.read();
+            if(c < 0)
+            {
+                unsigned long start = millis();
+                while(device.available() <= 0 && millis() - start < RELAY_TIMEOUT_MS) delay(1);
+                if(device.available() <= 0) break;
+                continue;
+            }
+            body.concat((char)c);
+        }
+
+        String fields[8];
+        int start = 0;
+        while(isUpdate && start < (int)body.length())
+        {
+            int end = body.indexOf('&', start);
+            if(end < 0) end = body.length();
+            String pair = body.substring(start, end);
+            start = end + 1;
+
+            if(pair.startsWith("field") && pair.length() > 7 && pair.charAt(6) == '=' && pair.charAt(5) >= '1' && pair.charAt(5) <= '8')
+            {
+                fields[pair.charAt(5) - '1'] = pair.substring(7);
+            }
+            else if(pair.startsWith("api_key="))
+            {
+                pair.substring(8).toCharArray(writeAPIKey, RELAY_KEY_MAX);
+            }
+        }
+
+        if(!isUpdate)
+        {
+            relayRespond(device, TS_ERR_BADURL, 0);
+            return TS_ERR_BADURL;
+        }
+        gatewayChannel * channel = relayFindChannel(channels, numChannels, writeAPIKey);
+        if(NULL == channel)
+        {
+            relayRespond(device, TS_ERR_BADAPIKEY, 0);
+            return TS_ERR_BADAPIKEY;
+        }
+
+        for(unsigned int f = 0; f < 8; f++)
+        {
+            if(fields[f].length() > 0) ThingSpeak.setField(f + 1, fields[f]);
+        }
+        int status = ThingSpeak.queueChannelFields(channel->channelNumber);
+        if(status != TS_OK_SUCCESS)
+        {
+            // the request was fine, its content was not taken
+            relayRespond(device, TS_OK_SUCCESS, 0);
+            return status;
+        }
+        relayRespond(device, TS_OK_SUCCESS, relayNextReceipt());
+        return TS_OK_SUCCESS;
+    }
+
+#endif
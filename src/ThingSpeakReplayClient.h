@@ -0,0 +1,121 @@
+/*
+  ThingSpeakReplayClient
+
+  ReplayClient answers every request with a recorded HTTP response instead of connecting to ThingSpeak,
+  so the library can be benchmarked without network latency.  The response is delivered in chunks of
+  chunkSize bytes, at most one chunk per read(buf, size).  With an arrival delay, one more chunk becomes
+  available every arrivalDelay microseconds after connecting, like a response that arrives piece by piece.
+  A request written after the whole response was read gets the response again on the same connection,
+  like a kept-alive connection.  With a connect delay, connecting takes that many microseconds, like a
+  TCP or TLS handshake.
+
+  Meant for tests and benchmarks only, like the sketches in extras/benchmark; it never talks to a
+  server, so a sketch that sends real updates must not use it.
+
+  Copyright 2020-2025, The MathWorks, Inc.
+
+  See the accompanying license file for licensing information.
+*/
+
+#ifndef ThingSpeakReplayClient_h
+    #define ThingSpeakReplayClient_h
+
+    #include <Arduino.h>
+    #include <Client.h>
+
+    class ReplayClient : public Client
+    {
+        public:
+            ReplayClient() : response(NULL), responseLength(0), position(0), chunkSize(0xFFFF), arrivalDelay(0), connectDelay(0), isOpen(false), connects(0), bytesWritten(0), writeCalls(0), bytesRead(0), readCalls(0) {}
+
+            // response must stay valid while the client is used
+            void setResponse(const char * response, size_t length) { this->response = response; this->responseLength = length; }
+            void setChunkSize(size_t chunkSize) { this->chunkSize = chunkSize; }
+            void setArrivalDelay(unsigned long arrivalDelay) { this->arrivalDelay = arrivalDelay; }
+            void setConnectDelay(unsigned long connectDelay) { this->connectDelay = connectDelay; }
+
+            int connect(IPAddress, uint16_t) { return open(); }
+            int connect(const char *, uint16_t) { return open(); }
+            #if defined(ARDUINO_ARCH_ESP32)
+                int connect(IPAddress, uint16_t, int32_t) { return open(); }
+                int connect(const char *, uint16_t, int32_t) { return open(); }
+            #endif
+            size_t write(uint8_t) { rewind(); writeCalls++; bytesWritten++; return 1; }
+            size_t write(const uint8_t *, size_t size) { rewind(); writeCalls++; bytesWritten += size; return size; }
+            int available()
+            {
+                if(!isOpen || position >= responseLength) return 0;
+                size_t arrived = responseLength;
+                if(arrivalDelay > 0)
+                {
+                    // chunk n arrives n * arrivalDelay microseconds after the connection was opened
+                    unsigned long chunks = (micros() - openedAt) / arrivalDelay;
+                    if(chunks * chunkSize < responseLength) arrived = chunks * chunkSize;
+                }
+                return (arrived > position) ? (int)(arrived - position) : 0;
+            }
+            int read()
+            {
+                readCalls++;
+                if(available() <= 0) return -1;
+                bytesRead++;
+                return (uint8_t)response[position++];
+            }
+            int read(uint8_t * buf, size_t size)
+            {
+                readCalls++;
+                size_t count = available();
+                if(count > size) count = size;
+                if(count > chunkSize) count = chunkSize;
+                memcpy(buf, response + position, count);
+                position += count;
+                bytesRead += count;
+                return (int)count;
+            }
+            int peek() { return (available() > 0) ? (uint8_t)response[position] : -1; }
+            void flush() {}
+            void stop() { isOpen = false; }
+            uint8_t connected() { return isOpen; }
+            operator bool() { return isOpen; }
+
+            void resetCounters() { connects = 0; bytesWritten = 0; writeCalls = 0; bytesRead = 0; readCalls = 0; }
+
+            const char * response;
+            size_t responseLength;
+            size_t position;
+            size_t chunkSize;
+            unsigned long arrivalDelay;
+            unsigned long connectDelay;
+            bool isOpen;
+            unsigned long connects;
+            unsigned long bytesWritten;
+            unsigned long writeCalls;
+            unsigned long bytesRead;
+            unsigned long readCalls;
+
+        private:
+            unsigned long openedAt;
+
+            int open()
+            {
+                unsigned long start = micros();
+                while(micros() - start < connectDelay);
+                connects++;
+                position = 0;
+                openedAt = micros();
+                isOpen = true;
+                return 1;
+            }
+
+            // the next request on a kept-alive connection
+            void rewind()
+            {
+                if(isOpen && position >= responseLength)
+                {
+                    position = 0;
+                    openedAt = micros();
+                }
+            }
+    };
+
+#endif